@@ -5,6 +5,7 @@
 #include <exception>
 #include <iostream>
 #include "Array.h"
+#include "Arena.h"
 
 
 /*     EXCEPTIONS     */
@@ -123,19 +124,27 @@ class AVL {
             }
         }
 
-        static void insert_aux(std::shared_ptr<_Node>& root, const Key& key, const Info& info) {
+        // returns false without changing the tree if key is already in it
+        static bool insert_aux(std::shared_ptr<_Node>& root, const Key& key, const Info& info) {
             if(!root) {
-                root = std::make_shared<_Node>(key, info);
-                return;
+                root = Arena::makeShared<_Node>(key, info);
+                return true;
             }
-            else if(key < root->key) {
-                insert_aux(root->left, key, info);
+            bool inserted;
+            if(key < root->key) {
+                inserted = insert_aux(root->left, key, info);
             }
-            else {  // key > root->key
-                insert_aux(root->right, key, info);
+            else if(root->key < key) {
+                inserted = insert_aux(root->right, key, info);
             }
-            balance_aux(root);
-            root->height = 1 + max(height(root->left), height(root->right));
+            else {
+                return false;
+            }
+            if(inserted) {
+                balance_aux(root);
+                root->height = 1 + max(height(root->left), height(root->right));
+            }
+            return inserted;
         }
 
         static void remove_aux(std::shared_ptr<_Node>& root, Key key) {
@@ -203,7 +212,7 @@ class AVL {
             if(!from) {
                 return nullptr;
             }
-            to = std::make_shared<_Node>(from->key, from->info);
+            to = Arena::makeShared<_Node>(from->key, from->info);
             to->left = deep_copy(from->left, to->left);
             to->right = deep_copy(from->right, to->right);
             return to;
@@ -218,11 +227,6 @@ class AVL {
             list.push_back(root.get());
             inorderToList(root->right, list);
         }
-        Array<_Node*> getTreeAsList() const {
-            Array<_Node*> list(number_of_nodes);
-            inorderToList(root, list);  // O(n)
-            return list; 
-        }
         class NodesComparator {
             public:
                 bool operator()(_Node* left, _Node* right) {
@@ -239,7 +243,7 @@ class AVL {
                 return nullptr;
             }
             int mid = (start+end)/2;
-            std::shared_ptr<_Node>root = std::make_shared<_Node>(list[mid]->key, list[mid]->info);
+            std::shared_ptr<_Node>root = Arena::makeShared<_Node>(list[mid]->key, list[mid]->info);
             root->left = getTreeFromListAux(list, start, mid-1);
             root->right = getTreeFromListAux(list, mid+1, end);
             return root;
@@ -255,7 +259,7 @@ class AVL {
         std::shared_ptr<_Node> root;
         int number_of_nodes = 0;
         AVL() = default;
-        AVL(Key key, Info info) : root(std::make_shared<_Node>(key, info)) { }
+        AVL(Key key, Info info) : root(Arena::makeShared<_Node>(key, info)) { }
         AVL(const AVL& other) {
             this->root = deep_copy(other.root, this->root);
             this->number_of_nodes = other.number_of_nodes;
@@ -272,6 +276,23 @@ class AVL {
             this->number_of_nodes = other.number_of_nodes;
             return *this;
         }
+        // moving hands the nodes over in O(1), the moved from tree is left empty
+        AVL(AVL&& other) noexcept : root(std::move(other.root)), number_of_nodes(other.number_of_nodes) {
+            other.number_of_nodes = 0;
+        }
+        AVL& operator=(AVL&& other) noexcept {
+            if(this == &other) {
+                return *this;
+            }
+            if(number_of_nodes > 0) {
+                clear_aux(root);
+            }
+            root = std::move(other.root);
+            number_of_nodes = other.number_of_nodes;
+            other.root = nullptr;
+            other.number_of_nodes = 0;
+            return *this;
+        }
         void copyRoot(const AVL& from) const {
             root = from.root;
         }
@@ -281,26 +302,50 @@ class AVL {
         }
 
         Info& getInfo(const Key& key) const {
-            std::shared_ptr<_Node> node = find(key);
-            if(!node) {
+            Info* info = try_get(key);
+            if(!info) {
                 throw KeyDoesNotExist();
             }
-            return node->info;
+            return *info;
         }
 
         void insert(const Key& key, const Info& info) {
-            if(find(key)) {
+            if(!try_insert(key, info)) {
                 throw KeyAlreadyExists();
             }
-            insert_aux(root, key, info);
-            number_of_nodes++;
         }
         void remove(const Key& key) {
-            if(!find(key)) {
+            if(!try_remove(key)) {
                 throw KeyDoesNotExist();
             }
+        }
+
+        /*** NON THROWING FUNCTIONS ***/
+        // for lookups that are expected to miss, a miss costs a branch instead of unwinding an exception
+
+        // the info of key, nullptr if it isn't in the tree. O(logn)
+        Info* try_get(const Key& key) const {
+            const std::shared_ptr<_Node>& node = find(key);
+            return node ? &node->info : nullptr;
+        }
+
+        // false if key is already in the tree, in a single descent. O(logn)
+        bool try_insert(const Key& key, const Info& info) {
+            if(!insert_aux(root, key, info)) {
+                return false;
+            }
+            number_of_nodes++;
+            return true;
+        }
+
+        // false if key isn't in the tree. O(logn)
+        bool try_remove(const Key& key) {
+            if(!find(key)) {
+                return false;
+            }
             remove_aux(root, key);
             number_of_nodes--;
+            return true;
         }
 
         Info& getMax() const {
@@ -361,6 +406,13 @@ class AVL {
         //     std::cout << std::endl;
         // }
 
+        // the nodes sorted by key, valid until the tree changes
+        Array<_Node*> getTreeAsList() const {
+            Array<_Node*> list(number_of_nodes);
+            inorderToList(root, list);  // O(n)
+            return list; 
+        }
+
         static Array<_Node*> mergeToList(const AVL& avl1, const AVL& avl2) {
             NodesComparator cmp;
             Array<_Node*> list1 = avl1.getTreeAsList();  // O(n)
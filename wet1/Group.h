@@ -8,18 +8,26 @@ struct MaxPlayerInfo {
     int id;
     int level;
     MaxPlayerInfo() : id(-1), level(-1) {}
+    // no player, ids are positive. level isn't a sentinel, in a group it is relative and can be negative
+    bool isEmpty() const {
+        return id == -1;
+    }
 };
 
 class Player;
+// the levels in level_tree, the levels of the group's players and max_level_player.level are all relative to
+// level_offset, so raising every player of the group is O(1) here (see PlayersManager::IncreaseGroupLevel).
 struct Group {
     int id;
     int size;
+    int level_offset;  // the real level of a player is player->level + level_offset
     AVL<int, std::shared_ptr<Level>> level_tree;
     MaxPlayerInfo max_level_player;
     
-    Group(const int id) : id(id), size(0), level_tree(), max_level_player() { }
+    Group(const int id) : id(id), size(0), level_offset(0), level_tree(), max_level_player() { }
 
-    Group(int id, AVL<int, std::shared_ptr<Level>>& level_tree) : id(id), size(0), level_tree(level_tree), max_level_player() { }
+    Group(int id, AVL<int, std::shared_ptr<Level>>&& level_tree) :
+        id(id), size(0), level_offset(0), level_tree(std::move(level_tree)), max_level_player() { }
 };
 
 #endif
\ No newline at end of file
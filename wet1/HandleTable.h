@@ -0,0 +1,76 @@
+#ifndef HANDLE_TABLE_H
+#define HANDLE_TABLE_H
+
+#include "Array.h"
+#include <memory>
+
+// The handles the managers give out for their players. A handle is the index of a slot in the table and the
+// generation of that slot: removing a player releases its slot and bumps the generation, so the handles of removed
+// players are refused in O(1) even when a new player gets the same id or the same memory. Released slots are reused,
+// a slot's generation only repeats after 2^32 releases. 0 is never a valid handle.
+template<class T>
+class HandleTable {
+    public:
+        typedef unsigned long long Handle;
+
+    private:
+        struct Slot {
+            std::shared_ptr<T> item;  // nullptr while the slot is free
+            unsigned int generation;
+            int next_free;
+
+            Slot() : item(nullptr), generation(0), next_free(-1) { }
+        };
+
+        Array<Slot> slots;
+        int first_free;  // -1 if every slot is taken
+
+        // the slot of a handle that is still valid, nullptr otherwise
+        Slot* slotOf(Handle handle) {
+            long long index = (long long)(handle & 0xffffffffULL) - 1;
+            if(index < 0 || index > slots.getSize()) {
+                return nullptr;
+            }
+            Slot& slot = slots[(int)index];
+            if(!slot.item || slot.generation != (unsigned int)(handle >> 32)) {
+                return nullptr;
+            }
+            return &slot;
+        }
+
+    public:
+        HandleTable() : slots(), first_free(-1) { }
+
+        // O(1) amortized, the table is unchanged if it throws
+        Handle add(const std::shared_ptr<T>& item) {
+            if(first_free < 0) {
+                slots.emplace_back();
+                first_free = slots.getSize();
+            }
+            int index = first_free;
+            Slot& slot = slots[index];
+            first_free = slot.next_free;
+            slot.item = item;
+            return ((Handle)slot.generation << 32) | (Handle)(index + 1);
+        }
+
+        // the item of a handle, nullptr if the handle was released or never given out. O(1)
+        std::shared_ptr<T> find(Handle handle) {
+            Slot* slot = slotOf(handle);
+            return slot ? slot->item : nullptr;
+        }
+
+        // invalidates the handle and frees its slot for reuse, does nothing if the handle isn't valid. O(1)
+        void release(Handle handle) {
+            Slot* slot = slotOf(handle);
+            if(!slot) {
+                return;
+            }
+            slot->item = nullptr;
+            slot->generation++;
+            slot->next_free = first_free;
+            first_free = (int)(slot - slots.getData());
+        }
+};
+
+#endif
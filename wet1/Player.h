@@ -14,11 +14,12 @@ struct Group;
 class Player {
     public:
         int id;
-        int level;
+        int level;  // relative to group->level_offset
         Group* group;
+        unsigned long long handle;  // the player's handle in the manager's HandleTable, 0 if none was given out
         // CompareType compare_method;
         Player(int id, int level = 1) : 
-                id(id), level(level), group(nullptr) { }
+                id(id), level(level), group(nullptr), handle(0) { }
 
         // void changeMethod() {
         //     if(compare_method == ByLevel) {
@@ -6,32 +6,31 @@
 ***********************************************************************************************************************/
 
 void PlayersManager::AddPlayerToLevelTree(AVL<int, std::shared_ptr<Level>>& level_tree, const std::shared_ptr<Player>& player) {
-    if(!level_tree.find(player->level)) {
-        std::shared_ptr<Level> level = std::make_shared<Level>(player->level);
-        level_tree.insert(player->level, level);
+    int real_level = levelOf(*player);
+    if(!level_tree.find(real_level)) {
+        std::shared_ptr<Level> level = Arena::makeShared<Level>(real_level);
+        level_tree.insert(real_level, level);
     }
-    (level_tree.getInfo(player->level))->player_tree.insert(player->id, player);
+    (level_tree.getInfo(real_level))->player_tree.insert(player->id, player);
 }
 
 void PlayersManager::AddPlayerToGroupTree(Group& group, const std::shared_ptr<Player>& player) {
     if(!group.level_tree.find(player->level)) {
         // Level* new_level = new Level(player.level);
-        std::shared_ptr<Level> new_level = std::make_shared<Level>(player->level);
+        std::shared_ptr<Level> new_level = Arena::makeShared<Level>(player->level);
         group.level_tree.insert(player->level, new_level);
     }
     (group.level_tree.getInfo(player->level))->player_tree.insert(player->id, player);
     group.size++;
     // max player level maintaince
-    if(player->level >= group.max_level_player.level) {
-        if(player->level == group.max_level_player.level) {
-            group.max_level_player.id = (player->id < group.max_level_player.id) ? player->id : group.max_level_player.id;
-            // group.max_level_player.id = std::min(player->id, group.max_level_player.id);  // not allowed to use std::min
-        }
-        else {
-            group.max_level_player.id = player->id;
-        }
+    if(group.max_level_player.isEmpty() || player->level > group.max_level_player.level) {
+        group.max_level_player.id = player->id;
         group.max_level_player.level = player->level;
     }
+    else if(player->level == group.max_level_player.level) {
+        group.max_level_player.id = (player->id < group.max_level_player.id) ? player->id : group.max_level_player.id;
+        // group.max_level_player.id = std::min(player->id, group.max_level_player.id);  // not allowed to use std::min
+    }
 }
 
 void PlayersManager::updatePlayersPointers(const std::shared_ptr<Group>& group, const std::shared_ptr<Node<int, std::shared_ptr<Player>>>& root) {
@@ -64,7 +63,85 @@ void PlayersManager::updateMaxLevel(const AVL<int, std::shared_ptr<Level>>& leve
     std::shared_ptr<Level>& max_level = level_tree.getMax();  // O(logn)
     std::shared_ptr<Player>& max_player = max_level->player_tree.getMin();  // O(logn)
     max_player_info.id = max_player->id;
-    max_player_info.level = max_player->level;
+    max_player_info.level = max_level->id;  // in the levels of the tree, relative to the group's offset in a group
+}
+
+int PlayersManager::levelOf(const Player& player) {
+    return player.level + player.group->level_offset;
+}
+
+void PlayersManager::shiftPlayers(const std::shared_ptr<Node<int, std::shared_ptr<Player>>>& root, int shift) {
+    if(!root) {
+        return;
+    }
+    root->info->level += shift;
+    shiftPlayers(root->left, shift);
+    shiftPlayers(root->right, shift);
+}
+
+// adding the same shift to every key keeps the order, so the tree stays valid without rebalancing
+void PlayersManager::shiftLevels(const std::shared_ptr<Node<int, std::shared_ptr<Level>>>& root, int shift) {
+    if(!root) {
+        return;
+    }
+    root->key += shift;
+    root->info->id += shift;
+    shiftPlayers(root->info->player_tree.root, shift);
+    shiftLevels(root->left, shift);
+    shiftLevels(root->right, shift);
+}
+
+// moves the group's offset into its levels and players, O(n) for n players in the group
+void PlayersManager::applyLevelOffset(Group& group) {
+    if(group.level_offset == 0) {
+        return;
+    }
+    shiftLevels(group.level_tree.root, group.level_offset);
+    if(!group.max_level_player.isEmpty()) {
+        group.max_level_player.level += group.level_offset;
+    }
+    group.level_offset = 0;
+}
+
+// the players of all that aren't in some, some must be a subset of all. O(n) for n players in all
+AVL<int, std::shared_ptr<Player>> PlayersManager::removePlayersOf(const AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some) {
+    Array<Node<int, std::shared_ptr<Player>>*> all_list = all.getTreeAsList();
+    Array<Node<int, std::shared_ptr<Player>>*> some_list = some.getTreeAsList();
+    Array<Node<int, std::shared_ptr<Player>>*> rest(all.number_of_nodes - some.number_of_nodes);
+    int j = 0;
+    for(int i = 0; i <= all_list.getSize(); ++i) {
+        if(j <= some_list.getSize() && some_list[j]->key == all_list[i]->key) {
+            j++;
+        }
+        else {
+            rest.push_back(all_list[i]);
+        }
+    }
+    return AVL<int, std::shared_ptr<Player>>::listToAVL(rest);
+}
+
+void PlayersManager::removePlayersOneByOne(AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some) {
+    Array<Node<int, std::shared_ptr<Player>>*> some_list = some.getTreeAsList();
+    for(int i = 0; i <= some_list.getSize(); ++i) {
+        all.remove(some_list[i]->key);  // O(logn)
+    }
+}
+
+void PlayersManager::addPlayersOneByOne(AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some) {
+    Array<Node<int, std::shared_ptr<Player>>*> some_list = some.getTreeAsList();
+    for(int i = 0; i <= some_list.getSize(); ++i) {
+        all.insert(some_list[i]->key, some_list[i]->info);  // O(logn)
+    }
+}
+
+// true if moving moved players one by one into or out of a level with others other players costs less than
+// rebuilding the level's tree in O(moved + others)
+bool PlayersManager::cheaperOneByOne(int moved, int others) {
+    int log = 1;
+    for(int size = moved + others; size > 1; size /= 2) {
+        log++;
+    }
+    return (long long)moved * log < moved + others;
 }
 
 Array<Node<int, std::shared_ptr<Level>>*> PlayersManager::removeDuplicates(const Array<Node<int, std::shared_ptr<Level>>*>& list) {
@@ -81,7 +158,7 @@ Array<Node<int, std::shared_ptr<Level>>*> PlayersManager::removeDuplicates(const
         else {
             AVL<int, std::shared_ptr<Player>> merged = AVL<int, std::shared_ptr<Player>>::merge(
                 list[i]->info->player_tree, list[i+1]->info->player_tree);  // O(m+n)
-            std::shared_ptr<Level> level = std::make_shared<Level>(list[i]->key, merged);
+            std::shared_ptr<Level> level = Arena::makeShared<Level>(list[i]->key, std::move(merged));
             list[i]->info = level;
             new_list.push_back(list[i]);
             i++;
@@ -123,7 +200,34 @@ void PlayersManager::ReverseInorderLevelTree(Array<int>& Players, const std::sha
  *                                             MEMBER FUNCTIONS                                                       *
 ***********************************************************************************************************************/
 
+PlayersManager* PlayersManager::create() {
+    Arena* arena = new Arena();
+    try {
+        ArenaScope scope(arena);
+        PlayersManager* manager = Arena::create<PlayersManager>();
+        manager->arena = arena;
+        return manager;
+    }
+    catch(...) {
+        delete arena;
+        throw;
+    }
+}
+
+// O(#chunks) for a manager made by create, its destructor isn't run
+void PlayersManager::destroy(PlayersManager* manager) {
+    if(!manager) {
+        return;
+    }
+    if(manager->arena) {
+        delete manager->arena;
+        return;
+    }
+    delete manager;
+}
+
 PMStatusType PlayersManager::AddGroup(int groupid) { //O(logk)
+    ArenaScope scope(arena);
     if(groupid <= 0) {
         return PM_INVALID_INPUT;
     }
@@ -131,7 +235,7 @@ PMStatusType PlayersManager::AddGroup(int groupid) { //O(logk)
         if(group_tree.find(groupid)) {
             return PM_FAILURE;
         }
-        std::shared_ptr<Group> group = std::make_shared<Group>(groupid);
+        std::shared_ptr<Group> group = Arena::makeShared<Group>(groupid);
         group_tree.insert(groupid, group);
     }
     catch(const std::bad_alloc& e) {
@@ -143,18 +247,23 @@ PMStatusType PlayersManager::AddGroup(int groupid) { //O(logk)
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::AddPlayer(const int playerid, const int groupid, const int level) { // O(logk) + log(logn)
+PMStatusType PlayersManager::AddPlayer(const int playerid, const int groupid, const int level, PlayerHandles::Handle* handle) { // O(logk) + log(logn)
+    ArenaScope scope(arena);
     if(playerid <= 0 || groupid <= 0 || level < 0) {
         return PM_INVALID_INPUT;
     }
     int allocations = 0;
-    if(group_tree.find(groupid) == nullptr || player_tree.find(playerid)) {  // O(logk) + log(logn)
+    std::shared_ptr<Group>* group_info = group_tree.try_get(groupid);  // O(logk)
+    if(!group_info || player_tree.find(playerid)) {  // O(logn)
         return PM_FAILURE;
     }
-    std::shared_ptr<Player> player = std::make_shared<Player>(playerid, level);
-    std::shared_ptr<Group>& group = group_tree.getInfo(groupid);  // O(logk)
+    std::shared_ptr<Group>& group = *group_info;
+    std::shared_ptr<Player> player = Arena::makeShared<Player>(playerid, level - group->level_offset);
     player->group = group.get();
     try {
+        if(handle) {
+            player->handle = handles.add(player);  // O(1) amortized
+        }
         player_tree.insert(playerid, player);
         allocations++;
         PlayersManager::AddPlayerToGroupTree(*(group.get()), player);
@@ -183,41 +292,68 @@ PMStatusType PlayersManager::AddPlayer(const int playerid, const int groupid, co
         }
         else if(allocations == 2) {
             player_tree.remove(playerid);
-            Level* level_obj = group->level_tree.getInfo(level).get();  // O(logn)
+            Level* level_obj = group->level_tree.getInfo(player->level).get();  // O(logn)
             level_obj->player_tree.remove(playerid);  // O(logn)
             group->size--;
         }
         else if(allocations == 3) {
             RemovePlayer(playerid);
         }
+        handles.release(player->handle);
         return PM_ALLOCATION_ERROR;
     }
     catch(const KeyAlreadyExists& e) {
+        handles.release(player->handle);
         return PM_FAILURE;
     }
+    if(handle) {
+        *handle = player->handle;
+    }
     return PM_SUCCESS;
 }
 
 PMStatusType PlayersManager::RemovePlayer(int playerid) { // O(logn)
+    ArenaScope scope(arena);
     if(playerid <= 0) {
         return PM_INVALID_INPUT;
     }
+    std::shared_ptr<Player>* player = player_tree.try_get(playerid);  // O(logn)
+    if(!player) {
+        return PM_FAILURE;
+    }
+    return RemovePlayerAux(**player);
+}
+
+PMStatusType PlayersManager::RemovePlayerByHandle(PlayerHandles::Handle handle) { // O(logn), without the search by id
+    ArenaScope scope(arena);
+    if(!handle) {
+        return PM_INVALID_INPUT;
+    }
+    std::shared_ptr<Player> player = handles.find(handle);  // O(1)
+    if(!player) {  // the player was removed
+        return PM_FAILURE;
+    }
+    return RemovePlayerAux(*player);
+}
+
+// the player is freed by the last removal, so only its fields are used
+PMStatusType PlayersManager::RemovePlayerAux(Player& player) {
     try {
-        if(player_tree.find(playerid) == nullptr) {  // O(logn)
-            return PM_FAILURE;
-        }
-        int player_level = player_tree.getInfo(playerid)->level;
-        Group* group = (player_tree.getInfo(playerid))->group;  // O(logn)
+        PlayerHandles::Handle handle = player.handle;
+        int playerid = player.id;
+        int player_level = player.level;
+        Group* group = player.group;
         Level* group_level = group->level_tree.getInfo(player_level).get();
         group_level->player_tree.remove(playerid);  // O(logn)
 
-        Level* level = level_tree.getInfo(player_level).get();
+        Level* level = level_tree.getInfo(player_level + group->level_offset).get();
         level->player_tree.remove(playerid);  // O(logn)
         player_tree.remove(playerid);  // O(logn)
 
         group->size--;
         if(group->size == 0) {
             not_empty_group_tree.remove(group->id);  // O(logn) because the n must be larger than the number of not empty groups (each group has atleast one player)
+            group->level_offset = 0;  // no levels left to shift, the next players start without an offset
         }
 
         if(level->player_tree.number_of_nodes == 0) {
@@ -228,6 +364,7 @@ PMStatusType PlayersManager::RemovePlayer(int playerid) { // O(logn)
         }
         updateMaxLevel(group->level_tree, group->max_level_player);
         updateMaxLevel(level_tree, this->max_level_player);
+        handles.release(handle);  // O(1)
     }
     catch(const KeyDoesNotExist& e) {
         return PM_FAILURE;
@@ -236,23 +373,32 @@ PMStatusType PlayersManager::RemovePlayer(int playerid) { // O(logn)
 }
 
 PMStatusType PlayersManager::ReplaceGroup(int groupid, int replacementid) { // O(logk + n + m)
+    ArenaScope scope(arena);
     if(groupid <= 0 || replacementid <= 0 || groupid == replacementid) {
         return PM_INVALID_INPUT;
     }
     try {
-        std::shared_ptr<Group> g1 = (group_tree.getInfo(groupid));
-        std::shared_ptr<Group> g2 = (group_tree.getInfo(replacementid));
+        std::shared_ptr<Group>* g1_info = group_tree.try_get(groupid);  // O(logk)
+        std::shared_ptr<Group>* g2_info = group_tree.try_get(replacementid);  // O(logk)
+        if(!g1_info || !g2_info) {
+            return PM_FAILURE;
+        }
+        std::shared_ptr<Group> g1 = *g1_info;
+        std::shared_ptr<Group> g2 = *g2_info;
 
         if(g1->size == 0)  {  // no players in group
             group_tree.remove(groupid);
             return PM_SUCCESS;
         }
+        // the new group starts without an offset
+        applyLevelOffset(*g1);  // O(n)
+        applyLevelOffset(*g2);  // O(m)
 
         auto merged_list = AVL<int, std::shared_ptr<Level>>::mergeToList(g1->level_tree, g2->level_tree);
-        auto no_duplicates_list = g2->size == 0 ? merged_list : removeDuplicates(merged_list);
+        auto no_duplicates_list = g2->size == 0 ? std::move(merged_list) : removeDuplicates(merged_list);
         AVL<int, std::shared_ptr<Level>> merged = AVL<int, std::shared_ptr<Level>>::listToAVL(no_duplicates_list);
         std::shared_ptr<Node<int, std::shared_ptr<Level>>> root = merged.root;
-        std::shared_ptr<Group> new_group = std::make_shared<Group>(replacementid, merged);
+        std::shared_ptr<Group> new_group = Arena::makeShared<Group>(replacementid, std::move(merged));
         new_group->size = g1->size + g2->size;
 
         PlayersManager::updateGroupPointers(new_group, root);
@@ -279,16 +425,37 @@ PMStatusType PlayersManager::ReplaceGroup(int groupid, int replacementid) { // O
 }
 
 PMStatusType PlayersManager::IncreaseLevel(int playerid, int levelincrease) { //O(logn)
+    ArenaScope scope(arena);
     if(playerid <= 0 || levelincrease <= 0) {
         return PM_INVALID_INPUT;
     }
+    std::shared_ptr<Player>* player = player_tree.try_get(playerid);  // O(logn)
+    if(!player) {
+        return PM_FAILURE;
+    }
+    return IncreaseLevelAux(*player, levelincrease);
+}
+
+PMStatusType PlayersManager::IncreaseLevelByHandle(PlayerHandles::Handle handle, int levelincrease) { //O(logn), without the search by id
+    ArenaScope scope(arena);
+    if(!handle || levelincrease <= 0) {
+        return PM_INVALID_INPUT;
+    }
+    std::shared_ptr<Player> player = handles.find(handle);  // O(1)
+    if(!player) {  // the player was removed
+        return PM_FAILURE;
+    }
+    return IncreaseLevelAux(player, levelincrease);
+}
+
+PMStatusType PlayersManager::IncreaseLevelAux(const std::shared_ptr<Player>& player, int levelincrease) {
     /** TODO: handle allocation failures (return tree to previous state)*/
 
     // bool new_level_tree = false;
     // bool new_group_level_tree = false;
     try { // O(logn)
-        std::shared_ptr<Player>& player = player_tree.getInfo(playerid);  // should throw if not found
-        Level* level = level_tree.getInfo(player->level).get();  // O(logn)
+        int offset = player->group->level_offset;
+        Level* level = level_tree.getInfo(player->level + offset).get();  // O(logn)
         Level* level_group = player->group->level_tree.getInfo(player->level).get();  // O(logn)
         level->player_tree.remove(player->id);  // O(logn)
         level_group->player_tree.remove(player->id);  // O(logn)
@@ -300,15 +467,16 @@ PMStatusType PlayersManager::IncreaseLevel(int playerid, int levelincrease) { //
         }
         
         player->level += levelincrease;
+        int real_level = player->level + offset;
 
-        if(!level_tree.find(player->level)) {  // create and insert new level to level_tree
-            std::shared_ptr<Level> new_level_ptr = std::make_shared<Level>(player->level);
-            level_tree.insert(player->level, new_level_ptr);
+        if(!level_tree.find(real_level)) {  // create and insert new level to level_tree
+            std::shared_ptr<Level> new_level_ptr = Arena::makeShared<Level>(real_level);
+            level_tree.insert(real_level, new_level_ptr);
             // new_level_tree = true;
         }
-        Level* new_level = level_tree.getInfo(player->level).get();  // O(logn)
+        Level* new_level = level_tree.getInfo(real_level).get();  // O(logn)
         if(!player->group->level_tree.find(player->level)) {  // create and insert new level to group->level_tree
-            std::shared_ptr<Level> new_level_ptr = std::make_shared<Level>(player->level);
+            std::shared_ptr<Level> new_level_ptr = Arena::makeShared<Level>(player->level);
             player->group->level_tree.insert(player->level, new_level_ptr);
             // new_group_level_tree = true;
         }
@@ -316,15 +484,15 @@ PMStatusType PlayersManager::IncreaseLevel(int playerid, int levelincrease) { //
         new_level->player_tree.insert(player->id, player);  // O(logn)
         new_level_group->player_tree.insert(player->id, player);  // O(logn)
         
-        if(player->level >= this->max_level_player.level) {
-            if(player->level == this->max_level_player.level) {
+        if(real_level >= this->max_level_player.level) {
+            if(real_level == this->max_level_player.level) {
                 this->max_level_player.id = (player->id < max_level_player.id) ? player->id : max_level_player.id;
                 // this->max_level_player.id = std::min(player->id, max_level_player.id);  // not allowed to use std::min
             }
             else {
                 this->max_level_player.id = player->id;
             }
-            this->max_level_player.level = player->level;
+            this->max_level_player.level = real_level;
         }
         // updateMaxLevel(level_tree, this->max_level_player);  // O(logn)
         updateMaxLevel(player->group->level_tree, player->group->max_level_player);  // O(logn)
@@ -338,7 +506,85 @@ PMStatusType PlayersManager::IncreaseLevel(int playerid, int levelincrease) { //
     return PM_SUCCESS;
 }
 
+/**
+ * IncreaseGroupLevel: raises every player of the group by levelincrease. the group's tree only gets a larger offset,
+ * O(1). level_tree is reconciled level by level: a level that holds only the group's players moves as a whole, and
+ * otherwise the group's players leave and join the level one by one or by a linear merge of the trees, whichever is
+ * cheaper. O(L*logn + sum of min(p*logn, p+a)) for L levels in the group, p of its players and a other players in a
+ * level, instead of n separate moves of O(logn) each.
+*/
+PMStatusType PlayersManager::IncreaseGroupLevel(int groupid, int levelincrease) {
+    ArenaScope scope(arena);
+    if(groupid <= 0 || levelincrease <= 0) {
+        return PM_INVALID_INPUT;
+    }
+    try {
+        std::shared_ptr<Group>* group_info = group_tree.try_get(groupid);  // O(logk)
+        if(!group_info) {
+            return PM_FAILURE;
+        }
+        Group* group = group_info->get();
+        if(group->size == 0) {
+            return PM_SUCCESS;
+        }
+        Array<Node<int, std::shared_ptr<Level>>*> group_levels = group->level_tree.getTreeAsList();  // O(L)
+        Array<std::shared_ptr<Level>> whole_levels(group_levels.getSize()+1);  // taken out of level_tree, or nullptr
+
+        // the group's players leave their levels
+        for(int i = 0; i <= group_levels.getSize(); ++i) {
+            const AVL<int, std::shared_ptr<Player>>& group_players = group_levels[i]->info->player_tree;
+            int old_level = group_levels[i]->key + group->level_offset;
+            std::shared_ptr<Level>& level = level_tree.getInfo(old_level);  // O(logn)
+            int others = level->player_tree.number_of_nodes - group_players.number_of_nodes;
+            if(others == 0) {
+                whole_levels.push_back(level);
+                level_tree.remove(old_level);  // O(logn)
+                continue;
+            }
+            whole_levels.push_back(nullptr);
+            if(cheaperOneByOne(group_players.number_of_nodes, others)) {
+                removePlayersOneByOne(level->player_tree, group_players);  // O(p*logn)
+            }
+            else {
+                level = Arena::makeShared<Level>(old_level, removePlayersOf(level->player_tree, group_players));  // O(p+a)
+            }
+        }
+        // and join their new levels
+        for(int i = 0; i <= group_levels.getSize(); ++i) {
+            const AVL<int, std::shared_ptr<Player>>& group_players = group_levels[i]->info->player_tree;
+            int new_level = group_levels[i]->key + group->level_offset + levelincrease;
+            std::shared_ptr<Level>* level = level_tree.try_get(new_level);  // O(logn)
+            if(!level) {
+                std::shared_ptr<Level> moved = whole_levels[i];
+                if(moved) {
+                    moved->id = new_level;
+                }
+                else {
+                    moved = Arena::makeShared<Level>(new_level, AVL<int, std::shared_ptr<Player>>(group_players));  // O(p)
+                }
+                level_tree.insert(new_level, moved);  // O(logn)
+            }
+            else if(cheaperOneByOne(group_players.number_of_nodes, (*level)->player_tree.number_of_nodes)) {
+                addPlayersOneByOne((*level)->player_tree, group_players);  // O(p*logn)
+            }
+            else {
+                *level = Arena::makeShared<Level>(new_level, AVL<int, std::shared_ptr<Player>>::merge((*level)->player_tree, group_players));  // O(p+a)
+            }
+        }
+        group->level_offset += levelincrease;  // the group's tree and max_level_player are relative to it
+        updateMaxLevel(level_tree, max_level_player);  // O(logn)
+    }
+    catch(std::bad_alloc& e) {
+        return PM_ALLOCATION_ERROR;
+    }
+    catch(KeyDoesNotExist& e) {
+        return PM_FAILURE;
+    }
+    return PM_SUCCESS;
+}
+
 PMStatusType PlayersManager::GetHighestLevel(int groupid, int* playerid) const {
+    ArenaScope scope(arena);
     if(groupid == 0 || playerid == nullptr) {
         return PM_INVALID_INPUT;
     }
@@ -346,14 +592,12 @@ PMStatusType PlayersManager::GetHighestLevel(int groupid, int* playerid) const {
         *playerid = max_level_player.id;
         return PM_SUCCESS;
     }
-    try {
-        Group* group = group_tree.getInfo(groupid).get();
-        *playerid = group->max_level_player.id;
-        return PM_SUCCESS;
-    }
-    catch(const KeyDoesNotExist& e) {
+    std::shared_ptr<Group>* group = group_tree.try_get(groupid);  // O(logk)
+    if(!group) {
         return PM_FAILURE;
     }
+    *playerid = (*group)->max_level_player.id;
+    return PM_SUCCESS;
 }
 
 // int* PlayersManager::GetAllPlayersByLevelAux(int num_of_players, AVL<int, std::shared_ptr<Level>>& level_tree) {
@@ -370,6 +614,7 @@ PMStatusType PlayersManager::GetHighestLevel(int groupid, int* playerid) const {
 // }
 
 PMStatusType PlayersManager::GetAllPlayersByLevel(int groupid, int **Players, int *numOfPlayers) const {
+    ArenaScope scope(arena);
     if(groupid == 0 || Players == nullptr || numOfPlayers == nullptr) {
         return PM_INVALID_INPUT;
     }
@@ -392,7 +637,11 @@ PMStatusType PlayersManager::GetAllPlayersByLevel(int groupid, int **Players, in
             } 
         }
         else {
-            Group* group = group_tree.getInfo(groupid).get();
+            std::shared_ptr<Group>* group_info = group_tree.try_get(groupid);  // O(logk)
+            if(!group_info) {
+                return PM_FAILURE;
+            }
+            Group* group = group_info->get();
             if(group->size == 0) {
                 *numOfPlayers = 0;
                 *Players = nullptr;
@@ -420,6 +669,7 @@ PMStatusType PlayersManager::GetAllPlayersByLevel(int groupid, int **Players, in
 }
 
 PMStatusType PlayersManager::GetGroupsHighestLevel(int numOfGroups, int** Players) const {
+    ArenaScope scope(arena);
     if(numOfGroups < 1 || Players == nullptr) {
         return PM_INVALID_INPUT;
     }
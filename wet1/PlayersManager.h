@@ -5,6 +5,8 @@
 #include "Group.h"
 #include "AVLTree.h"
 #include "Level.h"
+#include "Arena.h"
+#include "HandleTable.h"
 
 typedef enum {
     PM_ALLOCATION_ERROR = -2,
@@ -13,19 +15,33 @@ typedef enum {
     PM_SUCCESS = 0
 } PMStatusType;
 
+typedef HandleTable<Player> PlayerHandles;
+
+// a manager made by create lives in its own Arena with everything it allocates, and destroy frees all of it at once
+// instead of releasing the nodes one by one. every public function sets the manager's arena as the current one.
 class PlayersManager {
     private:
+        Arena* arena;  // nullptr if the manager was made with new
         AVL<int, std::shared_ptr<Group>> group_tree;
         AVL<int, std::shared_ptr<Group>> not_empty_group_tree;
         AVL<int, std::shared_ptr<Player>> player_tree;
         AVL<int, std::shared_ptr<Level>> level_tree;
         MaxPlayerInfo max_level_player;
+        PlayerHandles handles;
 
         static void AddPlayerToLevelTree(AVL<int, std::shared_ptr<Level>>& level_tree, const std::shared_ptr<Player>& player);
         static void AddPlayerToGroupTree(Group& group, const std::shared_ptr<Player>& player);
         static void updatePlayersPointers(const std::shared_ptr<Group>& group, const std::shared_ptr<Node<int, std::shared_ptr<Player>>>& root);
         static void updateGroupPointers(const std::shared_ptr<Group>& group, const std::shared_ptr<Node<int, std::shared_ptr<Level>>>& root);
         static void updateMaxLevel(const AVL<int, std::shared_ptr<Level>>& level_tree, MaxPlayerInfo& max_player_info);
+        static int levelOf(const Player& player);
+        static void shiftPlayers(const std::shared_ptr<Node<int, std::shared_ptr<Player>>>& root, int shift);
+        static void shiftLevels(const std::shared_ptr<Node<int, std::shared_ptr<Level>>>& root, int shift);
+        static void applyLevelOffset(Group& group);
+        static AVL<int, std::shared_ptr<Player>> removePlayersOf(const AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some);
+        static void removePlayersOneByOne(AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some);
+        static void addPlayersOneByOne(AVL<int, std::shared_ptr<Player>>& all, const AVL<int, std::shared_ptr<Player>>& some);
+        static bool cheaperOneByOne(int moved, int others);
 
         static Array<Node<int, std::shared_ptr<Level>>*> removeDuplicates(const Array<Node<int, std::shared_ptr<Level>>*>& list);
 
@@ -33,14 +49,24 @@ class PlayersManager {
         static void InorderPlayerTree(Array<int>& Players, const std::shared_ptr<Node<int, std::shared_ptr<Player>>>& root);
         static void ReverseInorderLevelTree(Array<int>& Players, const std::shared_ptr<Node<int, std::shared_ptr<Level>>>& root);
 
+        PMStatusType RemovePlayerAux(Player& player);
+        PMStatusType IncreaseLevelAux(const std::shared_ptr<Player>& player, int levelincrease);
+
         // static int* GetAllPlayersByLevelAux(int num_of_players, AVL<int, std::shared_ptr<Level>>& level_tree);
     public:
-        // PlayersManager();
+        PlayersManager() : arena(nullptr) { }
+        static PlayersManager* create();
+        static void destroy(PlayersManager* manager);
         PMStatusType AddGroup(int groupid);
-        PMStatusType AddPlayer(int playerid, int groupid, int level);
+        // if handle isn't null it is set to the new player's handle, which the ByHandle functions take instead of its
+        // id. once the player is removed they return PM_FAILURE for the handle
+        PMStatusType AddPlayer(int playerid, int groupid, int level, PlayerHandles::Handle* handle = nullptr);
         PMStatusType RemovePlayer(int playerid);
+        PMStatusType RemovePlayerByHandle(PlayerHandles::Handle handle);
         PMStatusType ReplaceGroup(int groupid, int replacementid);
         PMStatusType IncreaseLevel(int playerid, int levelincrease);
+        PMStatusType IncreaseLevelByHandle(PlayerHandles::Handle handle, int levelincrease);
+        PMStatusType IncreaseGroupLevel(int groupid, int levelincrease);
         PMStatusType GetHighestLevel(int groupid, int* playerid) const;
         PMStatusType GetAllPlayersByLevel(int groupid, int **Players, int *numOfPlayers) const;
         PMStatusType GetGroupsHighestLevel(int numOfGroups, int** Players) const;
@@ -0,0 +1,51 @@
+#include "Bench.h"
+#include "../library1.h"
+
+// FAILURE-heavy traffic (user-046): the calls ask for players and groups that don't exist, so every one of them
+// takes the miss path of its lookup. ns per call for every operation.
+// usage: miss_bench [players=100000] [calls=1000000]
+
+static const int GROUPS = 1000;
+
+int main(int argc, char** argv) {
+    int players = benchArg(argc, argv, 1, 100000);
+    int calls = benchArg(argc, argv, 2, 1000000);
+    BenchRandom random(46);
+    void* ds = Init();
+    for(int group = 1; group <= GROUPS; ++group) {
+        AddGroup(ds, group);
+    }
+    for(int id = 1; id <= players; ++id) {
+        AddPlayer(ds, id, random.range(1, GROUPS), random.range(0, 999));
+    }
+    int failures = 0;
+
+    double start = benchSeconds();
+    for(int i = 0; i < calls; ++i) {
+        failures += IncreaseLevel(ds, players+1+i, 1) == FAILURE;
+    }
+    printf("IncreaseLevel    %.0f ns\n", (benchSeconds() - start) * 1e9 / calls);
+
+    start = benchSeconds();
+    for(int i = 0; i < calls; ++i) {
+        failures += RemovePlayer(ds, players+1+i) == FAILURE;
+    }
+    printf("RemovePlayer     %.0f ns\n", (benchSeconds() - start) * 1e9 / calls);
+
+    start = benchSeconds();
+    for(int i = 0; i < calls; ++i) {
+        int player = 0;
+        failures += GetHighestLevel(ds, GROUPS+1+i, &player) == FAILURE;
+    }
+    printf("GetHighestLevel  %.0f ns\n", (benchSeconds() - start) * 1e9 / calls);
+
+    start = benchSeconds();
+    for(int i = 0; i < calls; ++i) {
+        failures += ReplaceGroup(ds, GROUPS+1+i, 1) == FAILURE;
+    }
+    printf("ReplaceGroup     %.0f ns\n", (benchSeconds() - start) * 1e9 / calls);
+
+    printf("%d of %d calls returned FAILURE\n", failures, 4*calls);
+    Quit(&ds);
+    return 0;
+}
@@ -3,7 +3,7 @@
 
 void *Init() {
     try {
-        PlayersManager *DS = new PlayersManager();
+        PlayersManager *DS = PlayersManager::create();
         return (void*)DS;
     }
     catch(const std::bad_alloc& e) {
@@ -25,6 +25,32 @@ StatusType AddPlayer(void *DS, int PlayerID, int GroupID, int Level) {
     return (StatusType)((PlayersManager*)DS)->AddPlayer(PlayerID, GroupID, Level);
 }
 
+StatusType AddPlayerWithHandle(void *DS, int PlayerID, int GroupID, int Level, PlayerHandle *Handle) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    PlayerHandles::Handle handle = 0;
+    StatusType res = (StatusType)((PlayersManager*)DS)->AddPlayer(PlayerID, GroupID, Level, Handle ? &handle : nullptr);
+    if(Handle && res == StatusType::SUCCESS) {
+        *Handle = handle;
+    }
+    return res;
+}
+
+StatusType RemovePlayerByHandle(void *DS, PlayerHandle Handle) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->RemovePlayerByHandle(Handle);
+}
+
+StatusType IncreaseLevelByHandle(void *DS, PlayerHandle Handle, int LevelIncrease) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->IncreaseLevelByHandle(Handle, LevelIncrease);
+}
+
 StatusType RemovePlayer(void *DS, int PlayerID) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -46,6 +72,13 @@ StatusType IncreaseLevel(void *DS, int PlayerID, int LevelIncrease) {
     return (StatusType)((PlayersManager*)DS)->IncreaseLevel(PlayerID, LevelIncrease);
 }
 
+StatusType IncreaseGroupLevel(void *DS, int GroupID, int LevelIncrease) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->IncreaseGroupLevel(GroupID, LevelIncrease);
+}
+
 StatusType GetHighestLevel(void *DS, int GroupID, int *PlayerID) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -73,6 +106,6 @@ void Quit(void** DS) {
     }
     // ((*(PlayersManager ** )DS))
     // ((*(PlayersManager **)DS))->~PlayersManager();
-    delete (PlayersManager*)(*DS);
+    PlayersManager::destroy((PlayersManager*)(*DS));  // frees the manager's arena at once
     *DS = nullptr;
 }
\ No newline at end of file
@@ -34,12 +34,26 @@ StatusType AddGroup(void *DS, int GroupID);
 
 StatusType AddPlayer(void *DS, int PlayerID, int GroupID, int Level);
 
+/* a handle of a player. 0 is never a valid handle */
+typedef unsigned long long PlayerHandle;
+
+/* like AddPlayer, and sets *Handle (if not NULL) to the new player's handle. the ByHandle functions take the handle
+ * instead of the id and skip the search for the player. once the player is removed they return FAILURE for its
+ * handle, even if a new player got the same id, and INVALID_INPUT for the handle 0 */
+StatusType AddPlayerWithHandle(void *DS, int PlayerID, int GroupID, int Level, PlayerHandle *Handle);
+
+StatusType RemovePlayerByHandle(void *DS, PlayerHandle Handle);
+
+StatusType IncreaseLevelByHandle(void *DS, PlayerHandle Handle, int LevelIncrease);
+
 StatusType RemovePlayer(void *DS, int PlayerID);
 
 StatusType ReplaceGroup(void *DS, int GroupID, int ReplacementID);
 
 StatusType IncreaseLevel(void *DS, int PlayerID, int LevelIncrease);
 
+StatusType IncreaseGroupLevel(void *DS, int GroupID, int LevelIncrease);
+
 StatusType GetHighestLevel(void *DS, int GroupID, int *PlayerID);
 
 StatusType GetAllPlayersByLevel(void *DS, int GroupID, int **Players, int *numOfPlayers);
@@ -38,10 +38,11 @@ typedef enum {
 	GETHIGHESTLEVEL_CMD = 6,
 	GETALLPLAYERS_CMD = 7,
 	GETGROUPSHIGHEST_CMD = 8,
-	QUIT_CMD = 9
+	QUIT_CMD = 9,
+	INCREASEGROUPLEVEL_CMD = 10
 } commandType;
 
-static const int numActions = 10;
+static const int numActions = 11;
 static const char *commandStr[] = {
 		"Init",
 		"AddGroup",
@@ -52,7 +53,8 @@ static const char *commandStr[] = {
 		"GetHighestLevel",
 		"GetAllPlayersByLevel",
 		"GetGroupsHighestLevel",
-		"Quit" };
+		"Quit",
+		"IncreaseGroupLevel" };
 
 static const char* ReturnValToStr(int val) {
 	switch (val) {
@@ -137,6 +139,7 @@ static errorType OnGetHighestLevel(void* DS, const char* const command);
 static errorType OnGetAllPlayersByLevel(void* DS, const char* const command);
 static errorType OnGetGroupsHighestLevel(void* DS, const char* const command);
 static errorType OnQuit(void** DS, const char* const command);
+static errorType OnIncreaseGroupLevel(void* DS, const char* const command);
 
 /***************************************************************************/
 /* Parser                                                                  */
@@ -181,6 +184,9 @@ static errorType parser(const char* const command) {
 	case (QUIT_CMD):
 		rtn_val = OnQuit(&DS, command_args);
 		break;
+	case (INCREASEGROUPLEVEL_CMD):
+		rtn_val = OnIncreaseGroupLevel(DS, command_args);
+		break;
 
 	case (COMMENT_CMD):
 		rtn_val = error_free;
@@ -309,6 +315,20 @@ static errorType OnIncreaseLevel(void* DS, const char* const command) {
 	return error_free;
 }
 
+/***************************************************************************/
+/* OnIncreaseGroupLevel                                                    */
+/***************************************************************************/
+static errorType OnIncreaseGroupLevel(void* DS, const char* const command) {
+	int groupID;
+	int levelIncrease;
+	ValidateRead(sscanf(command, "%d %d", &groupID, &levelIncrease), 2,
+			"IncreaseGroupLevel failed.\n");
+	StatusType res = IncreaseGroupLevel(DS, groupID, levelIncrease);
+
+	printf("IncreaseGroupLevel: %s\n", ReturnValToStr(res));
+	return error_free;
+}
+
 
 /***************************************************************************/
 /* OnGetHighestLevel                                                         */
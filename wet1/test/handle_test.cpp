@@ -0,0 +1,98 @@
+// Checks the player handles of the C interface: a handle works until its player is removed, and after that every
+// ByHandle function returns FAILURE for it and leaves the other players alone, also when a new player got the same
+// id or the freed memory of the old one.
+//
+// Build and run from this directory (with -fsanitize=address to also check that no freed player is read):
+//     g++ -std=c++11 -O2 -pthread -I.. -o handle_test handle_test.cpp ../PlayersManager.cpp ../library1.cpp
+//     ./handle_test
+
+#include "library1.h"
+#include <cstdio>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if(!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// the id of the highest player of the group (of all players if group is negative), 0 on failure
+static int highest(void* ds, int group) {
+    int id = 0;
+    return (GetHighestLevel(ds, group, &id) == SUCCESS) ? id : 0;
+}
+
+static void staleHandleOfReusedId() {
+    void* ds = Init();
+    AddGroup(ds, 1);
+    AddGroup(ds, 2);
+    PlayerHandle old_handle = 0;
+    check(AddPlayerWithHandle(ds, 1, 1, 1, &old_handle) == SUCCESS && old_handle != 0, "add player 1 with a handle");
+    check(RemovePlayer(ds, 1) == SUCCESS, "remove player 1 by id");
+    check(AddPlayer(ds, 1, 2, 1) == SUCCESS, "add a new player 1 to group 2");
+    check(AddPlayer(ds, 2, 2, 3) == SUCCESS, "add player 2 to group 2");
+
+    check(RemovePlayerByHandle(ds, old_handle) == FAILURE, "remove by the handle of the removed player 1");
+    check(IncreaseLevelByHandle(ds, old_handle, 5) == FAILURE, "raise by the handle of the removed player 1");
+    check(highest(ds, 2) == 2, "the new player 1 wasn't raised");
+    check(IncreaseLevel(ds, 1, 2) == SUCCESS && highest(ds, 2) == 1, "the new player 1 is still found by id");
+    Quit(&ds);
+}
+
+static void handleOfRemovedPlayer() {
+    void* ds = Init();
+    AddGroup(ds, 3);
+    PlayerHandle first = 0, second = 0;
+    check(AddPlayerWithHandle(ds, 2, 3, 1, &first) == SUCCESS, "add player 2 with a handle");
+    check(AddPlayer(ds, 1, 3, 2) == SUCCESS, "add player 1");
+    check(IncreaseLevelByHandle(ds, first, 2) == SUCCESS && highest(ds, 3) == 2, "raise player 2 by handle");
+    check(RemovePlayerByHandle(ds, first) == SUCCESS, "remove player 2 by handle");
+    check(RemovePlayerByHandle(ds, first) == FAILURE, "remove player 2 by handle twice");
+    check(RemovePlayer(ds, 2) == FAILURE, "player 2 is gone by id too");
+
+    // the next player takes the slot of the released handle, with a new generation
+    check(AddPlayerWithHandle(ds, 3, 3, 1, &second) == SUCCESS && second != first, "a new handle differs from a released one");
+    check(IncreaseLevelByHandle(ds, first, 5) == FAILURE, "the released handle stays refused");
+    check(IncreaseLevelByHandle(ds, second, 5) == SUCCESS && highest(ds, 3) == 3, "the new handle works");
+
+    check(RemovePlayerByHandle(ds, 0) == INVALID_INPUT, "the handle 0");
+    check(RemovePlayerByHandle(ds, (7ULL << 32) | 1000) == FAILURE, "a handle that was never given out");
+    Quit(&ds);
+}
+
+static void manyHandles(int players) {
+    void* ds = Init();
+    AddGroup(ds, 1);
+    PlayerHandle handles[2000];
+    for(int id = 1; id <= players; ++id) {
+        AddPlayerWithHandle(ds, id, 1, 0, &handles[id-1]);
+    }
+    for(int id = 2; id <= players; id += 2) {
+        RemovePlayer(ds, id);
+        AddPlayer(ds, id, 1, 0);  // same id, no handle
+    }
+    int refused = 0, raised = 0;
+    for(int id = 1; id <= players; ++id) {
+        StatusType res = IncreaseLevelByHandle(ds, handles[id-1], id);
+        refused += (res == FAILURE);
+        raised += (res == SUCCESS);
+    }
+    std::printf("%d handles: %d raised, %d refused\n", players, raised, refused);
+    check(raised == (players+1)/2 && refused == players/2, "only the handles of players that weren't removed work");
+    check(highest(ds, 1) == players - (players+1) % 2, "the highest raised player");
+    Quit(&ds);
+}
+
+int main() {
+    staleHandleOfReusedId();
+    handleOfRemovedPlayer();
+    manyHandles(2000);
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("passed\n");
+    return 0;
+}
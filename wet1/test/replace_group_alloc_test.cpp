@@ -0,0 +1,88 @@
+// Counts the heap allocations of ReplaceGroup. The merged level tree and the merged player trees of the shared levels
+// must be moved into the new group and levels, not copied, so a replace allocates one node per level and per player
+// of the rebuilt trees, the Level of every shared level and a constant number of arrays per merged tree.
+// A copy of the rebuilt trees adds one more node per level and per player of a shared level and fails the test.
+//
+// Build and run from this directory:
+//     g++ -std=c++11 -O2 -pthread -I.. -o replace_group_alloc_test replace_group_alloc_test.cpp ../PlayersManager.cpp
+//     ./replace_group_alloc_test
+
+#include "PlayersManager.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static long long allocations = 0;
+
+void* operator new(std::size_t bytes) {
+    allocations++;
+    void* p = std::malloc(bytes > 0 ? bytes : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// the arrays of one tree merge: the two inorder lists, the merged list and the cuts of the merge path
+static const long long ARRAYS_PER_MERGE = 4;
+// the list without duplicates, the new group and its nodes in the two group trees
+static const long long REPLACE_OVERHEAD = 4;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if(!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * replace: groups 1 and 2 get levels levels each, with per_level players in each level. shared of the levels of
+ * group 1 are also levels of group 2. checks the allocations of ReplaceGroup(1, 2) against the rebuilt trees.
+*/
+static void replace(int levels, int per_level, int shared) {
+    PlayersManager manager;  // made with new, so everything it allocates goes through operator new
+    check(manager.AddGroup(1) == PM_SUCCESS && manager.AddGroup(2) == PM_SUCCESS, "AddGroup");
+    int id = 1;
+    for(int level = 0; level < levels; ++level) {
+        for(int i = 0; i < per_level; ++i) {
+            check(manager.AddPlayer(id++, 1, level) == PM_SUCCESS, "AddPlayer to group 1");
+            check(manager.AddPlayer(id++, 2, levels - shared + level) == PM_SUCCESS, "AddPlayer to group 2");
+        }
+    }
+
+    long long before = allocations;
+    check(manager.ReplaceGroup(1, 2) == PM_SUCCESS, "ReplaceGroup");
+    long long used = allocations - before;
+
+    long long merged_levels = 2LL*levels - shared;
+    long long level_nodes = merged_levels + ARRAYS_PER_MERGE;
+    long long shared_levels = shared*(1 + 2LL*per_level + ARRAYS_PER_MERGE);  // a Level and its merged player tree
+    long long bound = level_nodes + shared_levels + REPLACE_OVERHEAD;
+    std::printf("levels %d, players per level %d, shared levels %d: %lld allocations, bound %lld\n",
+                levels, per_level, shared, used, bound);
+    check(used <= bound, "ReplaceGroup allocates more than the nodes of the rebuilt trees");
+}
+
+int main() {
+    replace(1000, 1, 0);
+    replace(1000, 4, 0);
+    replace(1000, 4, 1000);
+    replace(1000, 16, 500);
+    replace(10000, 2, 5000);
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("passed\n");
+    return 0;
+}
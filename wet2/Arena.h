@@ -0,0 +1,439 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#ifdef __linux__
+#include <cstdint>
+#include <sys/mman.h>
+#endif
+
+// chunks of this many bytes are carved into the small blocks. build with -DARENA_CHUNK_SIZE=<n> to change it
+#ifndef ARENA_CHUNK_SIZE
+#define ARENA_CHUNK_SIZE 65536
+#endif
+
+// build with -DARENA_HUGE_PAGES=1 to back new arenas with huge pages by default (see Arena::setHugePages)
+#ifndef ARENA_HUGE_PAGES
+#define ARENA_HUGE_PAGES 0
+#endif
+#define ARENA_HUGE_PAGE_SIZE (2*1024*1024)
+
+// An arena owns all the memory of one PlayersManager (see PlayersManager::create).
+// Small blocks are cut one after the other out of large chunks, so nodes allocated together sit together in memory,
+// and a freed small block is kept in a free list of its size for the next allocation of that size. Larger blocks
+// (big arrays, hash table buckets) come from the heap and are linked into a list. Destroying the arena frees all the
+// chunks and large blocks at once, in O(#chunks + #large blocks), without running the destructors of what is in them.
+//
+// The structures allocate through the static helpers below (makeShared, newArray, create), which use the arena of the
+// calling thread (see ArenaScope), or the heap when there is none. Every block remembers where it came from, so it can
+// be freed later whatever the current arena is. Parallel passes the arena of the caller on to its threads, and the
+// arena only takes its lock while such a parallel section is running (see beginShared).
+//
+// In huge page mode the chunks are 2MB and, like large blocks of 2MB or more, are mapped on 2MB pages, so a tree
+// descent over millions of nodes needs far fewer TLB entries. A mapping first asks for MAP_HUGETLB pages, then for
+// transparent huge pages with madvise(MADV_HUGEPAGE), and falls back to the heap where neither exists.
+class Arena {
+    private:
+        static const std::size_t ALIGNMENT = alignof(std::max_align_t);
+        static const std::size_t MAX_SMALL = 1024;  // larger blocks come from the heap
+        static const std::size_t SIZE_CLASSES = MAX_SMALL / ALIGNMENT;
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+        struct Chunk {
+            Chunk* next;
+            std::size_t bytes;
+            bool mapped;  // by mapPages, otherwise from the heap
+        };
+        // header of a large block, the block follows it
+        struct LargeBlock {
+            LargeBlock* prev;
+            LargeBlock* next;
+            std::size_t bytes;
+            bool mapped;
+            alignas(std::max_align_t) char padding[1];
+        };
+        // header of an array made by newArray or an object made by create, the elements follow it
+        struct ArrayHeader {
+            Arena* arena;
+            std::size_t count;
+            alignas(std::max_align_t) char padding[1];
+        };
+
+        std::mutex lock;  // the threads of a parallel merge share the arena of the caller
+        std::atomic<int> shared_sections;  // the parallel sections running on the arena, it is locked while there is one
+        bool huge_pages;
+        Chunk* chunks;
+        char* next_free;  // the unused end of the newest chunk
+        char* chunk_end;
+        FreeBlock* free_lists[SIZE_CLASSES];
+        LargeBlock* large_blocks;
+        std::size_t reserved;
+
+        static std::size_t roundUp(std::size_t bytes) {
+            return (bytes + ALIGNMENT-1) / ALIGNMENT * ALIGNMENT;
+        }
+        static std::size_t largeHeaderSize() {
+            return offsetof(LargeBlock, padding);
+        }
+        static std::size_t arrayHeaderSize() {
+            return offsetof(ArrayHeader, padding);
+        }
+
+        static bool& hugePagesSetting() {
+            static bool huge_pages = ARENA_HUGE_PAGES;
+            return huge_pages;
+        }
+
+        /**
+         * mapPages: maps bytes (a multiple of ARENA_HUGE_PAGE_SIZE) on huge pages if the system has any, returns
+         * nullptr if it can't map them at all.
+        */
+        static void* mapPages(std::size_t bytes) {
+#ifdef __linux__
+#ifdef MAP_HUGETLB
+            void* pages = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(pages != MAP_FAILED) {
+                return pages;
+            }
+#endif
+            // no reserved huge pages, map an aligned range and ask for transparent huge pages
+            std::size_t mapped = bytes + ARENA_HUGE_PAGE_SIZE;
+            char* start = static_cast<char*>(mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if(start == MAP_FAILED) {
+                return nullptr;
+            }
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(start);
+            std::size_t head = (ARENA_HUGE_PAGE_SIZE - address % ARENA_HUGE_PAGE_SIZE) % ARENA_HUGE_PAGE_SIZE;
+            if(head > 0) {
+                munmap(start, head);
+            }
+            munmap(start + head + bytes, mapped - head - bytes);
+#ifdef MADV_HUGEPAGE
+            madvise(start + head, bytes, MADV_HUGEPAGE);  // only a hint, the range works on 4K pages too
+#endif
+            return start + head;
+#else
+            (void)bytes;
+            return nullptr;
+#endif
+        }
+
+        static void unmapPages(void* pages, std::size_t bytes) {
+#ifdef __linux__
+            munmap(pages, bytes);
+#else
+            (void)pages;
+            (void)bytes;
+#endif
+        }
+
+        // bytes of memory for a chunk or large block, from mapPages if huge is set, otherwise from the heap
+        static void* allocatePages(std::size_t bytes, bool huge, bool* mapped) {
+            void* pages = huge ? mapPages(bytes) : nullptr;
+            *mapped = pages != nullptr;
+            return pages ? pages : ::operator new(bytes);
+        }
+
+        static void freePages(void* pages, std::size_t bytes, bool mapped) {
+            if(mapped) {
+                unmapPages(pages, bytes);
+            }
+            else {
+                ::operator delete(pages);
+            }
+        }
+
+        static std::size_t roundUpToHugePage(std::size_t bytes) {
+            return (bytes + ARENA_HUGE_PAGE_SIZE-1) / ARENA_HUGE_PAGE_SIZE * ARENA_HUGE_PAGE_SIZE;
+        }
+
+        void* allocateSmall(std::size_t bytes) {
+            FreeBlock*& free_list = free_lists[bytes/ALIGNMENT - 1];
+            if(free_list) {
+                FreeBlock* block = free_list;
+                free_list = block->next;
+                return block;
+            }
+            if(next_free + bytes > chunk_end) {
+                std::size_t chunk_bytes = huge_pages ? ARENA_HUGE_PAGE_SIZE : roundUp(sizeof(Chunk)) + ARENA_CHUNK_SIZE;
+                bool mapped = false;
+                Chunk* chunk = static_cast<Chunk*>(allocatePages(chunk_bytes, huge_pages, &mapped));
+                chunk->bytes = chunk_bytes;
+                chunk->mapped = mapped;
+                chunk->next = chunks;
+                chunks = chunk;
+                next_free = reinterpret_cast<char*>(chunk) + roundUp(sizeof(Chunk));
+                chunk_end = reinterpret_cast<char*>(chunk) + chunk_bytes;
+                reserved += chunk_bytes;
+            }
+            void* block = next_free;
+            next_free += bytes;
+            return block;
+        }
+
+        void* allocateLarge(std::size_t bytes) {
+            std::size_t block_bytes = largeHeaderSize() + bytes;
+            bool huge = huge_pages && block_bytes >= ARENA_HUGE_PAGE_SIZE;
+            if(huge) {
+                block_bytes = roundUpToHugePage(block_bytes);
+            }
+            bool mapped = false;
+            LargeBlock* block = static_cast<LargeBlock*>(allocatePages(block_bytes, huge, &mapped));
+            block->bytes = block_bytes;
+            block->mapped = mapped;
+            block->prev = nullptr;
+            block->next = large_blocks;
+            if(large_blocks) {
+                large_blocks->prev = block;
+            }
+            large_blocks = block;
+            reserved += block_bytes;
+            return reinterpret_cast<char*>(block) + largeHeaderSize();
+        }
+
+        void* allocateBlock(std::size_t bytes) {
+            return (bytes <= MAX_SMALL) ? allocateSmall(bytes) : allocateLarge(bytes);
+        }
+
+        void deallocateBlock(void* p, std::size_t bytes) {
+            if(bytes > MAX_SMALL) {
+                deallocateLarge(p);
+                return;
+            }
+            FreeBlock* block = static_cast<FreeBlock*>(p);
+            block->next = free_lists[bytes/ALIGNMENT - 1];
+            free_lists[bytes/ALIGNMENT - 1] = block;
+        }
+
+        void deallocateLarge(void* p) {
+            LargeBlock* block = reinterpret_cast<LargeBlock*>(static_cast<char*>(p) - largeHeaderSize());
+            if(block->prev) {
+                block->prev->next = block->next;
+            }
+            else {
+                large_blocks = block->next;
+            }
+            if(block->next) {
+                block->next->prev = block->prev;
+            }
+            reserved -= block->bytes;
+            freePages(block, block->bytes, block->mapped);
+        }
+
+    public:
+        explicit Arena(bool huge_pages = hugePagesSetting()) : huge_pages(huge_pages), chunks(nullptr), next_free(nullptr), chunk_end(nullptr), large_blocks(nullptr), reserved(0) {
+            shared_sections.store(0, std::memory_order_relaxed);
+            for(std::size_t i = 0; i < SIZE_CLASSES; ++i) {
+                free_lists[i] = nullptr;
+            }
+        }
+        // frees everything at once, the objects in the arena must not be used afterwards
+        ~Arena() {
+            while(chunks) {
+                Chunk* next = chunks->next;
+                freePages(chunks, chunks->bytes, chunks->mapped);
+                chunks = next;
+            }
+            while(large_blocks) {
+                LargeBlock* next = large_blocks->next;
+                freePages(large_blocks, large_blocks->bytes, large_blocks->mapped);
+                large_blocks = next;
+            }
+        }
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        // whether new arenas (e.g. the ones of PlayersManager::create) use huge pages. not thread safe, call before
+        // making the managers
+        static void setHugePages(bool huge_pages) {
+            hugePagesSetting() = huge_pages;
+        }
+        bool usesHugePages() const {
+            return huge_pages;
+        }
+
+        // the bytes the arena holds, used or free
+        std::size_t getReserved() const {
+            return reserved;
+        }
+
+        void* allocate(std::size_t bytes) {
+            bytes = roundUp(bytes > 0 ? bytes : 1);
+            if(shared_sections.load(std::memory_order_relaxed) == 0) {
+                return allocateBlock(bytes);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            return allocateBlock(bytes);
+        }
+
+        // bytes must be the size the block was allocated with
+        void deallocate(void* p, std::size_t bytes) {
+            bytes = roundUp(bytes > 0 ? bytes : 1);
+            if(shared_sections.load(std::memory_order_relaxed) == 0) {
+                deallocateBlock(p, bytes);
+                return;
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            deallocateBlock(p, bytes);
+        }
+
+        // Parallel calls beginShared before it starts the threads of a section on the arena and endShared after it
+        // joined them, the arena is only locked in between. outside of a section one thread at a time uses an arena,
+        // like a manager is used by one thread at a time
+        void beginShared() {
+            shared_sections.fetch_add(1);
+        }
+        void endShared() {
+            shared_sections.fetch_sub(1);
+        }
+
+        // the arena new allocations of the calling thread come from, nullptr for the heap
+        static Arena*& current() {
+            static thread_local Arena* arena = nullptr;
+            return arena;
+        }
+
+        // allocates from arena, or from the heap if arena is nullptr
+        static void* allocate(Arena* arena, std::size_t bytes) {
+            return arena ? arena->allocate(bytes) : ::operator new(bytes);
+        }
+        static void deallocate(Arena* arena, void* p, std::size_t bytes) {
+            if(arena) {
+                arena->deallocate(p, bytes);
+            }
+            else {
+                ::operator delete(p);
+            }
+        }
+
+        template<class T, class... Args>
+        static std::shared_ptr<T> makeShared(Args&&... args);
+
+        // like new T[count](), the array must be freed with deleteArray
+        template<class T>
+        static T* newArray(std::size_t count) {
+            Arena* arena = current();
+            ArrayHeader* header = static_cast<ArrayHeader*>(allocate(arena, arrayHeaderSize() + count*sizeof(T)));
+            header->arena = arena;
+            header->count = count;
+            T* elements = reinterpret_cast<T*>(reinterpret_cast<char*>(header) + arrayHeaderSize());
+            std::size_t constructed = 0;
+            try {
+                for(; constructed < count; ++constructed) {
+                    new (elements + constructed) T();
+                }
+            }
+            catch(...) {
+                while(constructed > 0) {
+                    elements[--constructed].~T();
+                }
+                deallocate(arena, header, arrayHeaderSize() + count*sizeof(T));
+                throw;
+            }
+            return elements;
+        }
+
+        template<class T>
+        static void deleteArray(T* elements) {
+            if(!elements) {
+                return;
+            }
+            ArrayHeader* header = reinterpret_cast<ArrayHeader*>(reinterpret_cast<char*>(elements) - arrayHeaderSize());
+            std::size_t count = header->count;
+            while(count > 0) {
+                elements[--count].~T();
+            }
+            deallocate(header->arena, header, arrayHeaderSize() + header->count*sizeof(T));
+        }
+
+        // like new T(args), the object must be freed with destroy or owned by adopt
+        template<class T, class... Args>
+        static T* create(Args&&... args) {
+            Arena* arena = current();
+            ArrayHeader* header = static_cast<ArrayHeader*>(allocate(arena, arrayHeaderSize() + sizeof(T)));
+            header->arena = arena;
+            header->count = 1;
+            T* object = reinterpret_cast<T*>(reinterpret_cast<char*>(header) + arrayHeaderSize());
+            try {
+                new (object) T(std::forward<Args>(args)...);
+            }
+            catch(...) {
+                deallocate(arena, header, arrayHeaderSize() + sizeof(T));
+                throw;
+            }
+            return object;
+        }
+
+        template<class T>
+        static void destroy(T* object) {
+            deleteArray(object);
+        }
+
+        // a shared_ptr that frees an object made by create, its control block comes from the current arena
+        template<class T>
+        static std::shared_ptr<T> adopt(T* object);
+};
+
+// A standard allocator over an arena, so allocate_shared can put a node and its control block in it
+template<class T>
+class ArenaAllocator {
+    public:
+        typedef T value_type;
+        Arena* arena;
+
+        explicit ArenaAllocator(Arena* arena) : arena(arena) { }
+        template<class U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) { }
+
+        T* allocate(std::size_t n) {
+            return static_cast<T*>(Arena::allocate(arena, n*sizeof(T)));
+        }
+        void deallocate(T* p, std::size_t n) {
+            Arena::deallocate(arena, p, n*sizeof(T));
+        }
+
+        template<class U>
+        bool operator==(const ArenaAllocator<U>& other) const {
+            return arena == other.arena;
+        }
+        template<class U>
+        bool operator!=(const ArenaAllocator<U>& other) const {
+            return arena != other.arena;
+        }
+};
+
+// like std::make_shared, from the current arena
+template<class T, class... Args>
+std::shared_ptr<T> Arena::makeShared(Args&&... args) {
+    return std::allocate_shared<T>(ArenaAllocator<T>(current()), std::forward<Args>(args)...);
+}
+
+template<class T>
+std::shared_ptr<T> Arena::adopt(T* object) {
+    return std::shared_ptr<T>(object, [](T* p) { Arena::destroy(p); }, ArenaAllocator<T>(current()));
+}
+
+// Makes arena the current arena of the calling thread until the end of the scope
+class ArenaScope {
+    private:
+        Arena* previous;
+
+    public:
+        explicit ArenaScope(Arena* arena) : previous(Arena::current()) {
+            Arena::current() = arena;
+        }
+        ~ArenaScope() {
+            Arena::current() = previous;
+        }
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+#endif
@@ -3,96 +3,252 @@
 
 #include <exception>
 #include <iostream>
+#include <utility>
+#include "Parallel.h"
 
-// This class implements an array which can only be populated using push_back.
+// merges of fewer elements than this run on a single thread, starting threads would cost more than they save.
+// build with -DARRAY_PARALLEL_MERGE_MIN=<n> to change it
+#ifndef ARRAY_PARALLEL_MERGE_MIN
+#define ARRAY_PARALLEL_MERGE_MIN 65536
+#endif
+
+// This class implements an array which can only be populated using push_back/emplace_back.
 // Implemented with an array and not a linked list due to simpler design.
+// The constructor reserves room for the expected number of elements, and the array doubles its capacity if more
+// are added. The elements are allocated from the current Arena. Arrays are moved instead of copied where possible, so returning one never copies the elements.
 
-class ArrayIsFull : public std::exception {
-    public:
-        const char* what() const noexcept override {
-            return "Array is Full.";
-        }
-};
+template<class T>
+class ArrayView;
 
 template<class T>
 class Array {
     private:
         T* data;
-        int size;
+        int capacity;
         int next_empty;
+
+        void grow(int min_capacity) {
+            int new_capacity = (capacity > 0) ? capacity*2 : 4;
+            if(new_capacity < min_capacity) {
+                new_capacity = min_capacity;
+            }
+            T* new_data = Arena::newArray<T>(new_capacity);
+            for(int i=0; i<next_empty; ++i) {
+                new_data[i] = std::move(data[i]);
+            }
+            Arena::deleteArray(data);
+            data = new_data;
+            capacity = new_capacity;
+        }
+
+        /**
+         * mergePathSplit: the number of elements of list1 among the first diagonal elements of the merge of list1
+         * and list2, found by a binary search on the merge path in O(log(n+m)). like the merge, equal elements are
+         * taken from list2 first.
+        */
+        template<class Compare>
+        static int mergePathSplit(ArrayView<T> list1, ArrayView<T> list2, int diagonal, Compare& cmp) {
+            int size1 = list1.getSize()+1, size2 = list2.getSize()+1;
+            int low = (diagonal > size2) ? diagonal - size2 : 0;
+            int high = (diagonal < size1) ? diagonal : size1;
+            while(low < high) {
+                int mid = (low+high)/2;
+                if(cmp(list1[mid], list2[diagonal-mid-1])) {
+                    low = mid+1;  // list1[mid] comes before list2[diagonal-mid-1]
+                }
+                else {
+                    high = mid;
+                }
+            }
+            return low;
+        }
+
+        /**
+         * mergeAux: merges the populated parts of two sorted arrays, moving the elements if move is true.
+         * large merges are cut into one equal part of the output per thread along the merge path, every cut is found
+         * before anything is moved, and every part is merged by its own thread into its own slice of the output,
+         * O((n+m)/threads + threads*log(n+m)).
+        */
+        template<class Compare>
+        static Array mergeAux(T* list1, int size1, T* list2, int size2, Compare& cmp, bool move) {
+            int total = size1 + size2;
+            int threads = (total >= ARRAY_PARALLEL_MERGE_MIN) ? Parallel::threads() : 1;
+            Array merged(total);
+            Array<int> cuts(threads+1);
+            for(int chunk = 0; chunk <= threads; ++chunk) {
+                cuts.push_back(mergePathSplit(ArrayView<T>(list1, size1), ArrayView<T>(list2, size2), (long long)total * chunk / threads, cmp));
+            }
+            T* out = merged.data;
+            Parallel::forEachChunk(threads, [&](int chunk) {
+                Compare chunk_cmp = cmp;
+                int begin = (long long)total * chunk / threads, end = (long long)total * (chunk+1) / threads;
+                int i = cuts[chunk], j = begin - i;
+                int end1 = cuts[chunk+1], end2 = end - end1;
+                for(int k = begin; k < end; ++k) {
+                    T& next = (j == end2 || (i < end1 && chunk_cmp(list1[i], list2[j]))) ? list1[i++] : list2[j++];
+                    if(move) {
+                        out[k] = std::move(next);
+                    }
+                    else {
+                        out[k] = next;
+                    }
+                }
+            });
+            merged.next_empty = total;
+            return merged;
+        }
+
     public:
-        // Array() : data(nullptr), size(0), next_empty(0) { }
-        Array(int size) : data(new T[size]), size(size), next_empty(0) { }
+        Array() : data(nullptr), capacity(0), next_empty(0) { }
+        Array(int capacity) : data(Arena::newArray<T>(capacity)), capacity(capacity), next_empty(0) { }
         ~Array() {
-            delete[] data;
+            Arena::deleteArray(data);
         }
         void clean() {
-            delete[] data;
+            Arena::deleteArray(data);
+            data = nullptr;
+            capacity = 0;
+            next_empty = 0;
         }
-        Array(const Array& other) {
-            size = other.size;
-            next_empty = other.next_empty;
-            data = new T[size];
-            for(int i=0; i<size; ++i) {
-                data[i] = other[i];
+        Array(const Array& other) : data(Arena::newArray<T>(other.capacity)), capacity(other.capacity), next_empty(other.next_empty) {
+            for(int i=0; i<next_empty; ++i) {
+                data[i] = other.data[i];
             }
         }
         Array(const Array& other, int len) {
-            size = std::min(other.size, len);
-            next_empty = std::min(other.next_empty, size);
-            data = new T[size];
-            for(int i=0; i<size; ++i) {
-                data[i] = other[i];
+            capacity = std::min(other.capacity, len);
+            next_empty = std::min(other.next_empty, capacity);
+            data = Arena::newArray<T>(capacity);
+            for(int i=0; i<next_empty; ++i) {
+                data[i] = other.data[i];
             }
         }
-        int getSize() const {
-            return size-1;
-        }
-        T* getData() {
-            return data;
+        Array(Array&& other) noexcept : data(other.data), capacity(other.capacity), next_empty(other.next_empty) {
+            other.data = nullptr;
+            other.capacity = 0;
+            other.next_empty = 0;
         }
         Array& operator=(const Array& other) {
             if(data == other.data) {
                 return *this;
             }
-            delete[] data;
-            size = other.size;
-            next_empty = other.next_empty;
-            data = new T[size];
-            for(int i=0; i<size; ++i) {
-                data[i] = other[i];
-            }
+            Array copy(other);
+            swap(copy);
+            return *this;
+        }
+        Array& operator=(Array&& other) noexcept {
+            swap(other);
             return *this;
         }
 
-        T operator[](int i) const {
+        // index of the last element, -1 if the array is empty
+        int getSize() const {
+            return next_empty-1;
+        }
+        int getCapacity() const {
+            return capacity;
+        }
+        T* getData() {
+            return data;
+        }
+        const T* getData() const {
+            return data;
+        }
+        // a view of the elements that doesn't own them, valid until the array grows or is destroyed
+        ArrayView<T> view() const {
+            return ArrayView<T>(data, next_empty);
+        }
+        // exchanges the contents of the arrays without copying the elements
+        void swap(Array& other) {
+            T* temp_data = data;
+            data = other.data;
+            other.data = temp_data;
+            int temp = capacity;
+            capacity = other.capacity;
+            other.capacity = temp;
+            temp = next_empty;
+            next_empty = other.next_empty;
+            other.next_empty = temp;
+        }
+        // marks the first count elements as populated, for callers that fill the array through getData()
+        void setPopulated(int count) {
+            next_empty = count;
+        }
+
+        T& operator[](int i) {
             return data[i];
         }
+        const T& operator[](int i) const {
+            return data[i];
+        }
+
+        void reserve(int new_capacity) {
+            if(new_capacity > capacity) {
+                grow(new_capacity);
+            }
+        }
 
         void push_back(const T& element) {
-            if(next_empty == size) {
-                throw ArrayIsFull();
+            if(next_empty == capacity) {
+                T copy(element);  // element may be in this array
+                grow(next_empty+1);
+                data[next_empty++] = std::move(copy);
+                return;
             }
-            data[next_empty++] = element;  // copies element (i think)
+            data[next_empty++] = element;
         }
 
+        void push_back(T&& element) {
+            if(next_empty == capacity) {
+                grow(next_empty+1);
+            }
+            data[next_empty++] = std::move(element);
+        }
+
+        template<class... Args>
+        void emplace_back(Args&&... args) {
+            push_back(T(std::forward<Args>(args)...));
+        }
+
+        // merges the populated parts of two sorted arrays, on several threads if they are large
         template<class Compare = std::less<T>>
         static Array merge(const Array& list1, const Array& list2, Compare cmp) {
-            // only merges initiallized parts
-            Array merged(list1.next_empty + list2.next_empty);
-            int i=0, j=0;
-            while(i<list1.next_empty && j<list2.next_empty) {
-                if(cmp(list1[i], list2[j])) {
-                    merged.push_back(list1[i++]);
-                }
-                else {
-                    merged.push_back(list2[j++]);
-                }
-            }
-            while(i<list1.next_empty) merged.push_back(list1[i++]);
-            while(j<list2.next_empty) merged.push_back(list2[j++]);
-            return merged;
+            // the elements are only read, the const_cast is for sharing mergeAux with the moving merge
+            return mergeAux(const_cast<T*>(list1.data), list1.next_empty, const_cast<T*>(list2.data), list2.next_empty, cmp, false);
+        }
+
+        // like merge, but moves the elements out of the lists instead of copying them
+        template<class Compare = std::less<T>>
+        static Array merge(Array&& list1, Array&& list2, Compare cmp) {
+            return mergeAux(list1.data, list1.next_empty, list2.data, list2.next_empty, cmp, true);
+        }
+};
+
+// A view of count consecutive elements of an Array (or of any buffer) that doesn't own them, so parts of a list
+// can be passed around without copying.
+template<class T>
+class ArrayView {
+    private:
+        const T* data;
+        int count;
+
+    public:
+        ArrayView(const T* data, int count) : data(data), count(count) { }
+
+        // index of the last element, -1 if the view is empty, like Array::getSize
+        int getSize() const {
+            return count-1;
+        }
+        const T* getData() const {
+            return data;
+        }
+        const T& operator[](int i) const {
+            return data[i];
+        }
+        // the count elements starting at start
+        ArrayView subView(int start, int count) const {
+            return ArrayView(data + start, count);
         }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,635 @@
+#include "BPlusRankTree.h"
+#include "Histogram.h"
+
+// leaves and internal nodes built by a merge are filled up to here, so the first inserts into them don't split them
+static const int BPLUS_FILL = BPLUS_FANOUT - BPLUS_FANOUT/4;
+
+/********************************** NODE FUNCTIONS **********************************/
+int BPlusRankTree::min(const int a, const int b) {
+    return (a < b) ? a : b;
+}
+
+int BPlusRankTree::max(const int a, const int b) {
+    return (a > b) ? a : b;
+}
+
+void BPlusRankTree::moveEntries(BPlusNode* dst, int dst_pos, BPlusNode* src, int src_pos, int count) {
+    for(int j = 0; j < count; ++j) {
+        dst->low[dst_pos+j] = src->low[src_pos+j];
+        dst->high[dst_pos+j] = src->high[src_pos+j];
+        dst->players[dst_pos+j] = src->players[src_pos+j];
+        dst->sum_levels[dst_pos+j] = src->sum_levels[src_pos+j];
+        Histogram::copy(dst->row(dst_pos+j), src->row(src_pos+j), src->scale);
+        dst->children[dst_pos+j] = std::move(src->children[src_pos+j]);
+    }
+}
+
+// makes room for a new entry at pos, the entry itself is left for the caller to fill
+void BPlusRankTree::openEntry(BPlusNode* node, int pos) {
+    for(int j = node->count; j > pos; --j) {
+        moveEntries(node, j, node, j-1, 1);
+    }
+    node->count++;
+}
+
+void BPlusRankTree::closeEntry(BPlusNode* node, int pos) {
+    for(int j = pos; j < node->count-1; ++j) {
+        moveEntries(node, j, node, j+1, 1);
+    }
+    node->count--;
+    node->children[node->count].reset();
+}
+
+// recalculates entry i of parent from the entries of its child, O(BPLUS_FANOUT*scale)
+void BPlusRankTree::summarize(BPlusNode* parent, int i) {
+    const BPlusNode* child = parent->children[i].get();
+    parent->low[i] = child->low[0];
+    parent->high[i] = child->high[child->count-1];
+    parent->players[i] = 0;
+    parent->sum_levels[i] = 0;
+    Histogram::reset(parent->row(i), parent->scale);
+    for(int j = 0; j < child->count; ++j) {
+        parent->players[i] += child->players[j];
+        parent->sum_levels[i] += child->sum_levels[j];
+        Histogram::add(parent->row(i), child->row(j), parent->scale);
+    }
+}
+
+// the first entry whose lowest level is at least level_id, node->count if there is none
+static int lowerBound(const BPlusNode* node, const int level_id) {
+    int lo = 0, hi = node->count;
+    while(lo < hi) {
+        int mid = (lo+hi)/2;
+        if(node->low[mid] < level_id) {
+            lo = mid+1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// the child of an internal node whose levels level_id belongs between
+int BPlusRankTree::findChild(const BPlusNode* node, const int level_id) {
+    int pos = lowerBound(node, level_id);
+    if(pos < node->count && node->low[pos] == level_id) {
+        return pos;
+    }
+    return max(0, pos-1);
+}
+
+// moves the upper half of a full node to a new right sibling and returns it
+std::shared_ptr<BPlusNode> BPlusRankTree::split(BPlusNode* node) {
+    std::shared_ptr<BPlusNode> sibling = Arena::makeShared<BPlusNode>(node->scale, node->is_leaf);
+    int half = node->count/2;
+    moveEntries(sibling.get(), 0, node, half, node->count-half);
+    sibling->count = node->count-half;
+    node->count = half;
+    return sibling;
+}
+
+// merges child i of parent with a neighbour if both fit in one node
+void BPlusRankTree::mergeUnderfullChild(BPlusNode* parent, int i) {
+    for(int left = i-1; left <= i; ++left) {
+        int right = left+1;
+        if(left < 0 || right >= parent->count) {
+            continue;
+        }
+        BPlusNode* left_node = parent->children[left].get();
+        BPlusNode* right_node = parent->children[right].get();
+        if(left_node->count + right_node->count <= BPLUS_FANOUT) {
+            moveEntries(left_node, left_node->count, right_node, 0, right_node->count);
+            left_node->count += right_node->count;
+            right_node->count = 0;
+            closeEntry(parent, right);
+            summarize(parent, left);
+            return;
+        }
+    }
+}
+
+/********************************** INSERT AND REMOVE FUNCTIONS **********************************/
+static void addToEntry(BPlusNode* node, int i, const int level_id, const int players, const int score, const int* hist) {
+    node->players[i] += players;
+    node->sum_levels[i] += (long long)level_id * players;
+    if(hist) {
+        Histogram::add(node->row(i), hist, node->scale);
+    }
+    else {
+        COUNT_HISTOGRAM_UPDATE();
+        node->row(i)[score] += players;
+    }
+    if(level_id < node->low[i]) {
+        node->low[i] = level_id;
+    }
+    if(level_id > node->high[i]) {
+        node->high[i] = level_id;
+    }
+}
+
+/**
+ * insertAux: adds players of one level to the subtree of node. if hist is not null it holds the scores of the players,
+ * otherwise they all have the given score. returns the new right sibling of node if node was split, nullptr otherwise.
+*/
+std::shared_ptr<BPlusNode> BPlusRankTree::insertAux(BPlusNode* node, const int level_id, const int players, const int score,
+                                                    const int* hist, bool* new_level) {
+    if(node->is_leaf) {
+        int pos = lowerBound(node, level_id);
+        if(pos < node->count && node->low[pos] == level_id) {
+            addToEntry(node, pos, level_id, players, score, hist);
+            return nullptr;
+        }
+        std::shared_ptr<BPlusNode> sibling = nullptr;
+        BPlusNode* target = node;
+        if(node->count == BPLUS_FANOUT) {
+            sibling = split(node);
+            if(pos > node->count) {
+                target = sibling.get();
+                pos -= node->count;
+            }
+        }
+        openEntry(target, pos);
+        target->low[pos] = level_id;
+        target->high[pos] = level_id;
+        target->players[pos] = 0;
+        target->sum_levels[pos] = 0;
+        Histogram::reset(target->row(pos), target->scale);
+        addToEntry(target, pos, level_id, players, score, hist);
+        *new_level = true;
+        return sibling;
+    }
+    int i = findChild(node, level_id);
+    std::shared_ptr<BPlusNode> child_sibling = insertAux(node->children[i].get(), level_id, players, score, hist, new_level);
+    if(!child_sibling) {
+        addToEntry(node, i, level_id, players, score, hist);  // O(1) or O(scale) for a whole level
+        return nullptr;
+    }
+    summarize(node, i);
+    std::shared_ptr<BPlusNode> sibling = nullptr;
+    BPlusNode* target = node;
+    int pos = i+1;
+    if(node->count == BPLUS_FANOUT) {
+        sibling = split(node);
+        if(pos > node->count) {
+            target = sibling.get();
+            pos -= node->count;
+        }
+    }
+    openEntry(target, pos);
+    target->children[pos] = child_sibling;
+    summarize(target, pos);
+    return sibling;
+}
+
+void BPlusRankTree::insertLevel(const int level_id, const int players, const int score, const int* hist) {
+    if(!root) {
+        root = Arena::makeShared<BPlusNode>(scale, true);
+    }
+    bool new_level = false;
+    std::shared_ptr<BPlusNode> sibling = insertAux(root.get(), level_id, players, score, hist, &new_level);  // O(logn)
+    if(sibling) {
+        std::shared_ptr<BPlusNode> new_root = Arena::makeShared<BPlusNode>(scale, false);
+        new_root->children[0] = root;
+        new_root->children[1] = sibling;
+        new_root->count = 2;
+        summarize(new_root.get(), 0);
+        summarize(new_root.get(), 1);
+        root = new_root;
+    }
+    if(new_level) {
+        number_of_levels++;
+    }
+}
+
+// removes one player from the subtree of node, returns false if its level is not in the subtree
+bool BPlusRankTree::removeAux(BPlusNode* node, const int level_id, const int score, bool* removed_level) {
+    if(node->is_leaf) {
+        int pos = lowerBound(node, level_id);
+        if(pos == node->count || node->low[pos] != level_id) {
+            return false;
+        }
+        node->players[pos]--;
+        node->sum_levels[pos] -= level_id;
+        COUNT_HISTOGRAM_UPDATE();
+        node->row(pos)[score]--;
+        if(node->players[pos] == 0) {
+            closeEntry(node, pos);
+            *removed_level = true;
+        }
+        return true;
+    }
+    int i = findChild(node, level_id);
+    BPlusNode* child = node->children[i].get();
+    if(!removeAux(child, level_id, score, removed_level)) {
+        return false;
+    }
+    if(child->count == 0) {
+        closeEntry(node, i);
+        return true;
+    }
+    node->players[i]--;
+    node->sum_levels[i] -= level_id;
+    COUNT_HISTOGRAM_UPDATE();
+    node->row(i)[score]--;
+    if(*removed_level) {
+        node->low[i] = child->low[0];
+        node->high[i] = child->high[child->count-1];
+        if(child->count < BPLUS_FANOUT/4) {
+            mergeUnderfullChild(node, i);
+        }
+    }
+    return true;
+}
+
+/********************************** MERGE FUNCTIONS **********************************/
+void BPlusRankTree::levelsToList(const BPlusNode* node, Array<BPlusLevel>& list) {
+    if(!node) {
+        return;
+    }
+    for(int i = 0; i < node->count; ++i) {
+        if(node->is_leaf) {
+            list.push_back(BPlusLevel(node->low[i], node->players[i], node->row(i)));
+        }
+        else {
+            levelsToList(node->children[i].get(), list);
+        }
+    }
+}
+
+Array<BPlusLevel> BPlusRankTree::getLevelsAsList() const {
+    Array<BPlusLevel> list(number_of_levels);
+    levelsToList(root.get(), list);  // O(n)
+    return list;
+}
+
+class LevelsComparator {
+    public:
+        bool operator()(const BPlusLevel& left, const BPlusLevel& right) {
+            return left.level_id < right.level_id;
+        }
+};
+
+/**
+ * mergeToListAux: merges the level lists of trees[start..end] pairwise, so a level is compared O(log(#trees)) times.
+ * a level may appear once per tree, the duplicates are combined by buildFromList.
+*/
+Array<BPlusLevel> BPlusRankTree::mergeToListAux(const Array<std::shared_ptr<BPlusRankTree>>& trees, int start, int end) {
+    if(start == end) {
+        return trees[start]->getLevelsAsList();
+    }
+    int mid = (start+end)/2;
+    LevelsComparator cmp;
+    Array<BPlusLevel> list1 = mergeToListAux(trees, start, mid);
+    Array<BPlusLevel> list2 = mergeToListAux(trees, mid+1, end);
+    return Array<BPlusLevel>::merge(list1, list2, cmp);
+}
+
+/**
+ * buildFromList: replaces the tree with the sorted levels of list, bottom up in O(n*scale).
+ * the leaves are filled first, then every level of internal nodes is built over the one below it.
+*/
+void BPlusRankTree::buildFromList(const Array<BPlusLevel>& list) {
+    int size = list.getSize()+1;
+    Array<std::shared_ptr<BPlusNode>> nodes(size/BPLUS_FILL + 1);
+    int number_of_nodes = 0;
+    std::shared_ptr<BPlusNode> leaf = nullptr;
+    int levels = 0;
+    for(int i = 0; i < size; ++i) {
+        const BPlusLevel& level = list[i];
+        if(!leaf || leaf->high[leaf->count-1] != level.level_id) {
+            if(!leaf || leaf->count == BPLUS_FILL) {
+                leaf = Arena::makeShared<BPlusNode>(scale, true);
+                nodes.push_back(leaf);
+                number_of_nodes++;
+            }
+            int pos = leaf->count++;
+            leaf->low[pos] = level.level_id;
+            leaf->high[pos] = level.level_id;
+            leaf->players[pos] = 0;
+            leaf->sum_levels[pos] = 0;
+            levels++;
+        }
+        addToEntry(leaf.get(), leaf->count-1, level.level_id, level.players, 0, level.hist);
+    }
+    while(number_of_nodes > 1) {
+        Array<std::shared_ptr<BPlusNode>> parents(number_of_nodes/BPLUS_FILL + 1);
+        int number_of_parents = 0;
+        std::shared_ptr<BPlusNode> parent = nullptr;
+        for(int i = 0; i < number_of_nodes; ++i) {
+            if(!parent || parent->count == BPLUS_FILL) {
+                parent = Arena::makeShared<BPlusNode>(scale, false);
+                parents.push_back(parent);
+                number_of_parents++;
+            }
+            int pos = parent->count++;
+            parent->children[pos] = nodes[i];
+            summarize(parent.get(), pos);
+        }
+        nodes = std::move(parents);
+        number_of_nodes = number_of_parents;
+    }
+    root = (number_of_nodes == 1) ? nodes[0] : nullptr;
+    number_of_levels = levels;
+}
+
+void BPlusRankTree::addLevelZero(const BPlusRankTree& other) {
+    if(!other.level_zero) {
+        return;
+    }
+    level_zero->players_in_level += other.level_zero->players_in_level;
+    level_zero->self_scores_hist.add(other.level_zero->self_scores_hist, scale);
+}
+
+void BPlusRankTree::clear() {
+    root = nullptr;
+    level_zero = nullptr;
+    number_of_levels = 0;
+}
+
+/**
+ * merge: merges other into this tree, leaving other empty. like RankTree::merge, a small tree is inserted level by
+ * level in O(m*logn*scale), otherwise both level lists are merged and the tree is rebuilt in O((n+m)*scale).
+*/
+void BPlusRankTree::merge(BPlusRankTree& other) {
+    int small = other.number_of_levels;
+    if(small * (depth() + 1) > small + number_of_levels) {
+        LevelsComparator cmp;
+        Array<BPlusLevel> list1 = getLevelsAsList();
+        Array<BPlusLevel> list2 = other.getLevelsAsList();
+        buildFromList(Array<BPlusLevel>::merge(list1, list2, cmp));  // O((n+m)*scale)
+    }
+    else {
+        Array<BPlusLevel> levels = other.getLevelsAsList();  // O(m)
+        for(int i = 0; i <= levels.getSize(); ++i) {
+            insertLevel(levels[i].level_id, levels[i].players, 0, levels[i].hist);  // O(logn*scale)
+        }
+    }
+    addLevelZero(other);
+    other.clear();
+}
+
+std::shared_ptr<BPlusRankTree> BPlusRankTree::merge(const Array<std::shared_ptr<BPlusRankTree>>& trees) {
+    int count = trees.getSize() + 1;
+    int largest = 0, total_levels = 0;
+    for(int i = 0; i < count; ++i) {
+        total_levels += trees[i]->number_of_levels;
+        if(trees[i]->number_of_levels > trees[largest]->number_of_levels) {
+            largest = i;
+        }
+    }
+    std::shared_ptr<BPlusRankTree> res = trees[largest];
+    int small = total_levels - res->number_of_levels;
+    if(small * (res->depth() + 1) <= total_levels) {
+        for(int i = 0; i < count; ++i) {
+            if(i != largest) {
+                res->merge(*trees[i]);
+            }
+        }
+        return res;
+    }
+    res = Arena::makeShared<BPlusRankTree>(trees[largest]->scale);
+    res->buildFromList(mergeToListAux(trees, 0, count-1));  // O(n*log(#trees) + n*scale)
+    for(int i = 0; i < count; ++i) {
+        res->addLevelZero(*trees[i]);
+        trees[i]->clear();
+    }
+    return res;
+}
+
+/********************************** RANK FUNCTIONS **********************************/
+void BPlusRankTree::addEntryToRange(LevelRange* range, const BPlusNode* node, int i, const int score) {
+    range->players += node->players[i];
+    range->sum_levels += node->sum_levels[i];
+    if(score >= 0 && score < node->scale) {
+        range->players_with_score += node->row(i)[score];
+    }
+    if(range->scores_hist) {
+        Histogram::add(range->scores_hist, node->row(i), node->scale);
+    }
+}
+
+void BPlusRankTree::addLevelZeroToRange(LevelRange* range, const TreeNode* level_zero, const int score) {
+    range->players += level_zero->players_in_level;
+    if(score >= 0 && score < level_zero->scale) {
+        range->players_with_score += level_zero->self_scores_hist.get(score);
+    }
+    if(range->scores_hist) {
+        level_zero->self_scores_hist.addTo(range->scores_hist, level_zero->scale);
+    }
+}
+
+/**
+ * levelRangeAux: aggregates the levels in [lower, upper]. every entry inside the range contributes its aggregates,
+ * so only the (at most two) entries of a node that cross a bound of the range are descended into, O(logn).
+*/
+void BPlusRankTree::levelRangeAux(const BPlusNode* node, const int lower, const int upper, const int score, LevelRange* range) {
+    if(!node) {
+        return;
+    }
+    for(int i = node->is_leaf ? lowerBound(node, lower) : findChild(node, lower); i < node->count && node->low[i] <= upper; ++i) {
+        if(node->high[i] < lower) {
+            continue;
+        }
+        if(lower <= node->low[i] && node->high[i] <= upper) {
+            addEntryToRange(range, node, i, score);
+        }
+        else {
+            levelRangeAux(node->children[i].get(), lower, upper, score, range);
+        }
+    }
+}
+
+LevelRange BPlusRankTree::getLevelRange(const int lower, const int upper, const int score) const {
+    LevelRange range;
+    if(upper < lower) {
+        return range;
+    }
+    levelRangeAux(root.get(), lower, upper, score, &range);
+    if(lower <= 0 && upper >= 0) {
+        addLevelZeroToRange(&range, level_zero.get(), score);
+    }
+    return range;
+}
+
+LevelRange BPlusRankTree::getScoreDistribution(const int lower, const int upper, int* hist) const {
+    Histogram::reset(hist, scale);
+    LevelRange range;
+    range.scores_hist = hist;
+    if(upper < lower) {
+        return range;
+    }
+    levelRangeAux(root.get(), lower, upper, -1, &range);
+    if(lower <= 0 && upper >= 0) {
+        addLevelZeroToRange(&range, level_zero.get(), -1);
+    }
+    return range;
+}
+
+double BPlusRankTree::getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const {
+    LevelRange range = getLevelRange(lower, upper, score);  // O(logn)
+    if(range.players == 0) {
+        return -1;
+    }
+    return 100 * double(range.players_with_score) / range.players;
+}
+
+/********************************** AVERAGE HIGHEST FUNCTIONS **********************************/
+long long BPlusRankTree::sumHighestPlayerLevelsAux(const BPlusNode* node, int m) {
+    long long sum = 0;
+    for(int i = node->count-1; i >= 0 && m > 0; --i) {
+        if(node->players[i] <= m) {
+            sum += node->sum_levels[i];
+            m -= node->players[i];
+        }
+        else if(node->is_leaf) {
+            return sum + (long long)m * node->low[i];
+        }
+        else {
+            return sum + sumHighestPlayerLevelsAux(node->children[i].get(), m);
+        }
+    }
+    return sum;
+}
+
+double BPlusRankTree::averageHighestPlayerLevelByGroup(int m) const {
+    return double(sumHighestPlayerLevels(m)) / m;
+}
+
+long long BPlusRankTree::sumHighestPlayerLevels(int m) const {
+    if(!root || m <= 0) {
+        return 0;  // the rest of the players are in level zero
+    }
+    return sumHighestPlayerLevelsAux(root.get(), m);  // O(logn)
+}
+
+int BPlusRankTree::selectLevelAux(const BPlusNode* node, int k) {
+    for(int i = node->count-1; i >= 0; --i) {
+        if(node->players[i] >= k) {
+            return node->is_leaf ? node->low[i] : selectLevelAux(node->children[i].get(), k);
+        }
+        k -= node->players[i];
+    }
+    return 0;
+}
+
+int BPlusRankTree::selectLevel(int k) const {
+    if(!root) {
+        return 0;
+    }
+    return selectLevelAux(root.get(), k);  // O(logn), 0 if the player is in level zero
+}
+
+void BPlusRankTree::getPlayersBoundsAux(const BPlusNode* node, int score, int m, int* lower, int* upper) {
+    for(int i = node->count-1; i >= 0 && m > 0; --i) {
+        int at_score = node->row(i)[score];
+        if(node->players[i] <= m) {
+            *lower += at_score;
+            *upper += at_score;
+            m -= node->players[i];
+        }
+        else if(node->is_leaf) {
+            *lower += max(0, m - (node->players[i] - at_score));
+            *upper += min(m, at_score);
+            return;
+        }
+        else {
+            getPlayersBoundsAux(node->children[i].get(), score, m, lower, upper);
+            return;
+        }
+    }
+}
+
+void BPlusRankTree::getPlayersBounds(int score, int m, int* lower, int* upper) const {
+    if(score < 0 || score >= scale) {
+        return;
+    }
+    int in_tree = getPlayersInTree() - level_zero->players_in_level;
+    if(root) {
+        getPlayersBoundsAux(root.get(), score, min(m, in_tree), lower, upper);  // O(logn)
+    }
+    if(m > in_tree) {
+        // the rest from level zero
+        int remaining = m - in_tree;
+        int zero_at_score = level_zero->self_scores_hist.get(score);
+        *lower += max(0, remaining - (level_zero->players_in_level - zero_at_score));
+        *upper += min(remaining, zero_at_score);
+    }
+}
+
+/********************************** INTERFACE FUNCTIONS **********************************/
+BPlusRankTree::BPlusRankTree(int scale) : scale(scale), root(nullptr), number_of_levels(0), level_zero(Arena::makeShared<TreeNode>(scale, 0)) { }
+
+int BPlusRankTree::getPlayersInTree() const {
+    int players = level_zero->players_in_level;
+    for(int i = 0; root && i < root->count; ++i) {
+        players += root->players[i];
+    }
+    return players;
+}
+
+int BPlusRankTree::depth() const {
+    int depth = 0;
+    for(const BPlusNode* node = root.get(); node; node = node->is_leaf ? nullptr : node->children[0].get()) {
+        depth++;
+    }
+    return depth;
+}
+
+void BPlusRankTree::insert(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level++;
+        level_zero->self_scores_hist.increase(player->score, 1, scale);
+        return;
+    }
+    insertLevel(player->level, 1, player->score, nullptr);  // O(logn)
+}
+
+void BPlusRankTree::removePlayer(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level--;
+        level_zero->self_scores_hist.increase(player->score, -1, scale);
+        return;
+    }
+    if(!root) {
+        return;
+    }
+    bool removed_level = false;
+    removeAux(root.get(), player->level, player->score, &removed_level);  // O(logn)
+    if(removed_level) {
+        number_of_levels--;
+    }
+    if(root->count == 0) {
+        root = nullptr;
+    }
+    while(root && !root->is_leaf && root->count == 1) {
+        root = root->children[0];
+    }
+}
+
+void BPlusRankTree::change_player_score(const int level, const int old_score, const int new_score) {
+    if(level == 0) {
+        level_zero->self_scores_hist.increase(old_score, -1, scale);
+        level_zero->self_scores_hist.increase(new_score, 1, scale);
+        return;
+    }
+    const BPlusNode* leaf = root.get();
+    while(leaf && !leaf->is_leaf) {
+        leaf = leaf->children[findChild(leaf, level)].get();
+    }
+    int pos = leaf ? lowerBound(leaf, level) : 0;
+    if(!leaf || pos == leaf->count || leaf->low[pos] != level) {
+        return;
+    }
+    for(BPlusNode* node = root.get(); node; ) {  // O(logn), one counter per tree level
+        int i = node->is_leaf ? pos : findChild(node, level);
+        COUNT_HISTOGRAM_UPDATES(2);
+        node->row(i)[old_score]--;
+        node->row(i)[new_score]++;
+        node = node->is_leaf ? nullptr : node->children[i].get();
+    }
+}
+
+void BPlusRankTree::movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level) {
+    reinsertPlayer(*this, player, old_level, new_level);  // O(logn)
+}
@@ -0,0 +1,111 @@
+#ifndef BPLUS_RANKTREE_H
+#define BPLUS_RANKTREE_H
+#include "RankTree.h"
+#include "Player.h"
+#include "Array.h"
+#include <memory>
+
+const int BPLUS_FANOUT = 32;
+
+// Entry i of a leaf is a level: low[i] = high[i] = the level id, players[i] the players in the level and row i of hist
+// the level's score histogram. Entry i of an internal node is the child children[i]: low[i] and high[i] are the lowest
+// and highest level under it, players[i], sum_levels[i] and row i of hist the aggregates of all the levels under it.
+struct BPlusNode {
+    bool is_leaf;
+    int count;
+    int scale;
+    int low[BPLUS_FANOUT];
+    int high[BPLUS_FANOUT];
+    int players[BPLUS_FANOUT];
+    long long sum_levels[BPLUS_FANOUT];
+    int* hist;  // BPLUS_FANOUT rows of scale counters
+    std::shared_ptr<BPlusNode> children[BPLUS_FANOUT];
+
+    BPlusNode(int scale, bool is_leaf) : is_leaf(is_leaf), count(0), scale(scale), hist(Arena::newArray<int>(BPLUS_FANOUT*scale)) { }
+    ~BPlusNode() {
+        Arena::deleteArray(hist);
+    }
+    int* row(int i) {
+        return hist + i*scale;
+    }
+    const int* row(int i) const {
+        return hist + i*scale;
+    }
+};
+
+// a level of a tree being merged, hist points into the leaf of the tree it came from
+struct BPlusLevel {
+    int level_id;
+    int players;
+    const int* hist;
+
+    BPlusLevel(int level_id=0, int players=0, const int* hist=nullptr) : level_id(level_id), players(players), hist(hist) { }
+};
+
+// A RankTree with the same operations, built as a B+tree of fanout BPLUS_FANOUT.
+// The levels and their own histograms live in the leaves and every internal node keeps one aggregated histogram per
+// child, so an update touches one histogram counter per tree level and never rebuilds a histogram for a rotation,
+// and the depth is log(n)/log(BPLUS_FANOUT/2) instead of ~1.44*log(n).
+// Nodes are split when they overflow. A node that drops under a quarter full is merged into a neighbour if both
+// fit in one node, and an empty node is removed, so the depth is bounded by the most levels the tree ever held.
+class BPlusRankTree {
+    private:
+        static int min(const int a, const int b);
+        static int max(const int a, const int b);
+        static void moveEntries(BPlusNode* dst, int dst_pos, BPlusNode* src, int src_pos, int count);
+        static void openEntry(BPlusNode* node, int pos);
+        static void closeEntry(BPlusNode* node, int pos);
+        static void summarize(BPlusNode* parent, int i);
+        static int findChild(const BPlusNode* node, const int level_id);
+        static std::shared_ptr<BPlusNode> split(BPlusNode* node);
+        static void mergeUnderfullChild(BPlusNode* parent, int i);
+
+        static std::shared_ptr<BPlusNode> insertAux(BPlusNode* node, const int level_id, const int players, const int score,
+                                                    const int* hist, bool* new_level);
+        static bool removeAux(BPlusNode* node, const int level_id, const int score, bool* removed_level);
+        void insertLevel(const int level_id, const int players, const int score, const int* hist);
+
+        static void addEntryToRange(LevelRange* range, const BPlusNode* node, int i, const int score);
+        static void levelRangeAux(const BPlusNode* node, const int lower, const int upper, const int score, LevelRange* range);
+        static void addLevelZeroToRange(LevelRange* range, const TreeNode* level_zero, const int score);
+
+        static void levelsToList(const BPlusNode* node, Array<BPlusLevel>& list);
+        Array<BPlusLevel> getLevelsAsList() const;
+        static Array<BPlusLevel> mergeToListAux(const Array<std::shared_ptr<BPlusRankTree>>& trees, int start, int end);
+        void buildFromList(const Array<BPlusLevel>& list);
+        void addLevelZero(const BPlusRankTree& other);
+        void clear();
+
+        static long long sumHighestPlayerLevelsAux(const BPlusNode* node, int m);
+        static int selectLevelAux(const BPlusNode* node, int k);
+        static void getPlayersBoundsAux(const BPlusNode* node, int score, int m, int* lower, int* upper);
+
+    public:
+        int scale;
+        std::shared_ptr<BPlusNode> root;
+        int number_of_levels = 0;  // levels in the tree, level 0 is not counted
+        std::shared_ptr<TreeNode> level_zero;  // kept outside the tree like in RankTree, only its self counts are used
+
+        BPlusRankTree(int scale);
+
+        int getPlayersInTree() const;
+        int depth() const;
+
+        void insert(std::shared_ptr<Player>& player);
+        void removePlayer(std::shared_ptr<Player>& player);
+        void merge(BPlusRankTree& other);
+        static std::shared_ptr<BPlusRankTree> merge(const Array<std::shared_ptr<BPlusRankTree>>& trees);
+        LevelRange getLevelRange(const int lower, const int upper, const int score) const;
+        LevelRange getScoreDistribution(const int lower, const int upper, int* hist) const;
+        double getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const;
+        double averageHighestPlayerLevelByGroup(int m) const;
+        long long sumHighestPlayerLevels(int m) const;
+        int selectLevel(int k) const;
+
+        void change_player_score(const int level, const int old_score, const int new_score);
+        void movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level);
+
+        void getPlayersBounds(int score, int m, int* lower, int* higher) const;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef CONCURRENT_UF_H
+#define CONCURRENT_UF_H
+
+#include "Arena.h"
+#include <atomic>
+
+// Lock-free union-find over the ids 0..k-1 (Jayanti & Tarjan style), the concurrent forest of UF.
+// Find uses path splitting with CAS, so it never blocks and runs in parallel with other Finds and Unions.
+// Union links roots with a single CAS, using randomized linking (every id gets a fixed pseudo random priority and
+// the root with the lower priority is linked under the other), which keeps the expected depth O(logk) without ranks.
+class ConcurrentUF {
+    private:
+        int k;
+        std::atomic<int>* parent;
+
+        static unsigned int priority(int id) {
+            unsigned int x = (unsigned int)id;
+            x ^= x >> 16;
+            x *= 0x7feb352dU;
+            x ^= x >> 15;
+            x *= 0x846ca68bU;
+            x ^= x >> 16;
+            return x;
+        }
+
+        static bool linksUnder(int a, int b) {
+            // true if root a should be linked under root b
+            unsigned int pa = priority(a), pb = priority(b);
+            return (pa < pb) || (pa == pb && a < b);
+        }
+
+    public:
+        ConcurrentUF(int k) : k(k), parent(Arena::newArray<std::atomic<int>>(k)) {
+            for(int i=0; i<k; ++i) {
+                parent[i].store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~ConcurrentUF() {
+            Arena::deleteArray(parent);
+        }
+
+        ConcurrentUF(const ConcurrentUF&) = delete;
+        ConcurrentUF& operator=(const ConcurrentUF&) = delete;
+
+        int Size() const {
+            return k;
+        }
+
+        // path splitting: every node on the path is pointed to its grandparent. a failed CAS means another thread
+        // already changed that pointer (only ever to an ancestor), so it is skipped instead of retried
+        int Find(int id) {
+            int current = id;
+            while(true) {
+                int p = parent[current].load(std::memory_order_acquire);
+                int gp = parent[p].load(std::memory_order_acquire);
+                if(p == gp) {
+                    return p;
+                }
+                int expected = p;
+                parent[current].compare_exchange_weak(expected, gp, std::memory_order_release, std::memory_order_relaxed);
+                current = p;
+            }
+        }
+
+        // unites the groups of group1 and group2 and returns the root of the united group
+        int Union(int group1, int group2) {
+            while(true) {
+                int root1 = Find(group1);
+                int root2 = Find(group2);
+                if(root1 == root2) {
+                    return root1;
+                }
+                if(linksUnder(root2, root1)) {
+                    int temp = root1;
+                    root1 = root2;
+                    root2 = temp;
+                }
+                // root1 goes under root2, only succeeds if root1 is still a root
+                int expected = root1;
+                if(parent[root1].compare_exchange_strong(expected, root2, std::memory_order_acq_rel)) {
+                    return root2;
+                }
+            }
+        }
+
+        bool SameGroup(int group1, int group2) {
+            while(true) {
+                int root1 = Find(group1);
+                int root2 = Find(group2);
+                if(root1 == root2) {
+                    return true;
+                }
+                // root1 may have been linked meanwhile, the answer is only final if it is still a root
+                if(parent[root1].load(std::memory_order_acquire) == root1) {
+                    return false;
+                }
+            }
+        }
+};
+
+#endif
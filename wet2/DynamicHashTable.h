@@ -2,6 +2,7 @@
 #define DynamicHashTable_H
 
 #include "Player.h"
+#include "Arena.h"
 #include <memory>
 #include <exception>
 
@@ -43,37 +44,51 @@ struct LinkedList {
     }
     void insert(const std::shared_ptr<Player>& player) {
         // Node* new_node = new Node(player, head);
-        std::shared_ptr<Node> new_node = std::make_shared<Node>(player, head);
+        std::shared_ptr<Node> new_node = Arena::makeShared<Node>(player, head);
         head = new_node;
         size++;
     }
+    // links an existing node in at the head, no allocation
+    void insertNode(std::shared_ptr<Node>&& node) {
+        node->next = std::move(head);
+        head = std::move(node);
+        size++;
+    }
+    // unlinks the head node and hands it over, the list must not be empty
+    std::shared_ptr<Node> popNode() {
+        std::shared_ptr<Node> node = std::move(head);
+        head = std::move(node->next);
+        size--;
+        return node;
+    }
     void remove(std::shared_ptr<Player>& player) {
-        if(head == nullptr) {
+        if(tryRemove(player->playerID) == nullptr) {
             throw PlayerDoesntExists();
         }
-        if(player->playerID == head->data->playerID) {
+    }
+    // unlinks the player and returns it, nullptr if it isn't in the list
+    std::shared_ptr<Player> tryRemove(int PlayerID) {
+        if(head == nullptr) {
+            return nullptr;
+        }
+        if(PlayerID == head->data->playerID) {
             // remove from top of list
-            // Node* garbage = head;
-            std::shared_ptr<Node> garbage = head;
-            head = head->next;
-            garbage->next = nullptr;
-            // delete garbage;
-            garbage = nullptr;
+            std::shared_ptr<Node> garbage = std::move(head);
+            head = std::move(garbage->next);
             size--;
-            return;
+            return garbage->data;
         }
-        std::shared_ptr<Node> temp = head;
-        while(temp->next != nullptr && temp->next->data->playerID != player->playerID) {
-            temp = temp->next;
+        Node* temp = head.get();
+        while(temp->next != nullptr && temp->next->data->playerID != PlayerID) {
+            temp = temp->next.get();
         }
-        std::shared_ptr<Node> garbage = temp->next;
-        if(garbage == nullptr) {
-            throw PlayerDoesntExists();
-        };
-        temp->next = garbage->next;
-        // delete garbage;
-        // garbage = nullptr;
+        if(temp->next == nullptr) {
+            return nullptr;
+        }
+        std::shared_ptr<Node> garbage = std::move(temp->next);
+        temp->next = std::move(garbage->next);
         size--;
+        return garbage->data;
     }
     std::shared_ptr<Player> findPlayer(int PlayerID)
     {
@@ -98,20 +113,22 @@ class DHT {
     public:
         int size;
         int number_of_players;
-        DHT(int size=2) : players(new LinkedList[size]), size(size), number_of_players(0) { }
+        DHT(int size=2) : players(Arena::newArray<LinkedList>(size)), size(size), number_of_players(0) { }
 
         ~DHT() {
-            delete[] players;
+            Arena::deleteArray(players);
         }
 
-        DHT& operator=(const DHT& other) {
-            if(this == &other) {
-                return *this;
-            }
-            delete[] players;
-            this->players = other.players;
-            this->size = other.size;
-            this->number_of_players = other.number_of_players;
+        // the table owns its buckets, so it can only be moved. a moved from table is empty and can still be used
+        DHT(const DHT& other) = delete;
+        DHT& operator=(const DHT& other) = delete;
+        DHT(DHT&& other) noexcept : players(other.players), size(other.size), number_of_players(other.number_of_players) {
+            other.players = nullptr;
+            other.size = 0;
+            other.number_of_players = 0;
+        }
+        DHT& operator=(DHT&& other) noexcept {
+            swap(other);
             return *this;
         }
 
@@ -140,41 +157,71 @@ class DHT {
         }
 
         void addPlayer(const std::shared_ptr<Player>& player) {
-            if(findPlayer(player->playerID) != nullptr) {
+            if(!tryAddPlayer(player)) {
                 throw PlayerAlreadyExists();
             }
+        }
+
+        void removePlayer(std::shared_ptr<Player> player) {
+            if(tryRemovePlayer(player->playerID) == nullptr) {
+                throw PlayerDoesntExists();
+            }
+        }
+
+        /*** NON THROWING FUNCTIONS ***/
+        // false if a player with the same id is already in the table
+        bool tryAddPlayer(const std::shared_ptr<Player>& player) {
+            if(findPlayer(player->playerID) != nullptr) {
+                return false;
+            }
+            if(size == 0) {
+                resize(2);  // moved from
+            }
             players[hashFunction(player->playerID, size)].insert(player);
             number_of_players++;
             if(number_of_players > size/2) {
                 resize(size*2);
             }
+            return true;
         }
 
-        void removePlayer(std::shared_ptr<Player> player) {
-            players[hashFunction(player->playerID, size)].remove(player);
+        // removes the player and returns it, nullptr if it isn't in the table
+        std::shared_ptr<Player> tryRemovePlayer(int PlayerID) {
+            if(size == 0) {
+                return nullptr;
+            }
+            std::shared_ptr<Player> player = players[hashFunction(PlayerID, size)].tryRemove(PlayerID);
+            if(player == nullptr) {
+                return nullptr;
+            }
             number_of_players--;
             if(number_of_players < size/4 && size > 2) {
                 resize(size/2);
             }
+            return player;
         }
 
         std::shared_ptr<Player> findPlayer(int PlayerID) {
+            if(size == 0) {
+                return nullptr;
+            }
             std::shared_ptr<Player> player = players[hashFunction(PlayerID, size)].findPlayer(PlayerID);
             return player;
         }
 
+        // the nodes are relinked into the new buckets, so only the bucket array is allocated
         void resize(int new_size) {
-            LinkedList* new_players = new LinkedList[new_size];
+            LinkedList* new_players = Arena::newArray<LinkedList>(new_size);
             for(int i=0; i<size; ++i) {
-                std::shared_ptr<Node> iterator = players[i].head;
-                while(iterator != nullptr) {
-                    new_players[hashFunction(iterator->data->playerID, new_size)].insert(iterator->data);
-                    iterator = iterator->next;
+                while(players[i].head != nullptr) {
+                    std::shared_ptr<Node> node = players[i].popNode();
+                    int bucket = hashFunction(node->data->playerID, new_size);
+                    new_players[bucket].insertNode(std::move(node));
                 }
             }
             LinkedList* temp = players;
             players = new_players;
-            delete[] temp;
+            Arena::deleteArray(temp);
             size = new_size;
         }
 
@@ -207,6 +254,40 @@ class DHT {
                  }
              }
          }
+
+         // like merge, but takes over the nodes of other instead of allocating new ones, leaving other empty.
+         // the ids are checked before anything is moved, so a duplicate leaves both tables as they were.
+         // the table is resized once up front, O(n+m)
+         void merge(DHT&& other) {
+             for(int i=0; i<other.size; ++i) {
+                 for(Node* iterator = other.players[i].head.get(); iterator; iterator = iterator->next.get()) {
+                     if(findPlayer(iterator->data->playerID) != nullptr) {
+                         throw PlayerAlreadyExists();
+                     }
+                 }
+             }
+             int new_size = (size > 0) ? size : 2;
+             while(number_of_players + other.number_of_players > new_size/2) {
+                 new_size *= 2;
+             }
+             if(new_size != size) {
+                 resize(new_size);
+             }
+             for(int i=0; i<other.size; ++i) {
+                 while(other.players[i].head != nullptr) {
+                     int bucket = hashFunction(other.players[i].head->data->playerID, size);
+                     players[bucket].insertNode(other.players[i].popNode());
+                     number_of_players++;
+                     other.number_of_players--;
+                 }
+             }
+         }
+
+         static DHT merge(DHT&& dht1, DHT&& dht2) {
+             DHT merged(std::move(dht1));
+             merged.merge(std::move(dht2));
+             return merged;
+         }
 };
 
 #endif
\ No newline at end of file
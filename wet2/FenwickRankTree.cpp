@@ -0,0 +1,241 @@
+#include "FenwickRankTree.h"
+#include "Histogram.h"
+
+/********************************** HELPER FUNCTIONS **********************************/
+int FenwickRankTree::min(const int a, const int b) {
+    return (a < b) ? a : b;
+}
+
+int FenwickRankTree::max(const int a, const int b) {
+    return (a > b) ? a : b;
+}
+
+void FenwickRankTree::update(const int level, const int score, const int count) {
+    for(int i = level; i <= max_level; i += i & -i) {  // O(log(max_level))
+        counts[i] += count;
+        sums[i] += (long long)level * count;
+        hists[i*scale + score] += count;
+    }
+}
+
+int FenwickRankTree::prefixCount(int level) const {
+    int count = 0;
+    for(int i = min(level, max_level); i > 0; i -= i & -i) {
+        count += counts[i];
+    }
+    return count;
+}
+
+long long FenwickRankTree::prefixSum(int level) const {
+    long long sum = 0;
+    for(int i = min(level, max_level); i > 0; i -= i & -i) {
+        sum += sums[i];
+    }
+    return sum;
+}
+
+int FenwickRankTree::prefixAtScore(int level, const int score) const {
+    int count = 0;
+    for(int i = min(level, max_level); i > 0; i -= i & -i) {
+        count += hists[i*scale + score];
+    }
+    return count;
+}
+
+/**
+ * findLowest: the level of the k-th lowest player in the tree (1 <= k <= players in the tree) by binary lifting,
+ * O(log(max_level)). if sum is not null it is set to the sum of the levels of the k lowest players.
+*/
+int FenwickRankTree::findLowest(int k, long long* sum) const {
+    int step = 1;
+    while(step*2 <= max_level) {
+        step *= 2;
+    }
+    int position = 0;
+    long long below = 0;
+    for(; step > 0; step /= 2) {
+        if(position + step <= max_level && counts[position + step] < k) {
+            position += step;
+            k -= counts[position];
+            below += sums[position];
+        }
+    }
+    if(sum) {
+        *sum = below + (long long)k * (position+1);
+    }
+    return position+1;
+}
+
+/********************************** MEMORY FUNCTIONS **********************************/
+void FenwickRankTree::clear() {
+    Arena::deleteArray(counts);
+    Arena::deleteArray(sums);
+    Arena::deleteArray(hists);
+    counts = nullptr;
+    sums = nullptr;
+    hists = nullptr;
+    level_zero = nullptr;
+}
+
+/********************************** RANK FUNCTIONS **********************************/
+LevelRange FenwickRankTree::getLevelRange(const int lower, const int upper, const int score) const {
+    LevelRange range;
+    if(upper < lower) {
+        return range;
+    }
+    bool valid_score = score >= 0 && score < scale;
+    int low = max(lower, 1), high = min(upper, max_level);
+    if(low <= high) {
+        range.players = prefixCount(high) - prefixCount(low-1);  // O(log(max_level))
+        range.sum_levels = prefixSum(high) - prefixSum(low-1);
+        if(valid_score) {
+            range.players_with_score = prefixAtScore(high, score) - prefixAtScore(low-1, score);
+        }
+    }
+    if(lower <= 0 && upper >= 0) {
+        range.players += level_zero->players_in_level;
+        range.players_with_score += valid_score ? level_zero->self_scores_hist.get(score) : 0;
+    }
+    return range;
+}
+
+LevelRange FenwickRankTree::getScoreDistribution(const int lower, const int upper, int* hist) const {
+    Histogram::reset(hist, scale);
+    LevelRange range = getLevelRange(lower, upper, -1);
+    range.scores_hist = hist;
+    if(upper < lower) {
+        return range;
+    }
+    int low = max(lower, 1), high = min(upper, max_level);
+    if(low <= high) {
+        // prefix(high) - prefix(low-1), the partial differences never drop below zero
+        for(int i = high; i > 0; i -= i & -i) {
+            Histogram::add(hist, hists + i*scale, scale);
+        }
+        for(int i = low-1; i > 0; i -= i & -i) {
+            Histogram::subtract(hist, hists + i*scale, scale);
+        }
+    }
+    if(lower <= 0 && upper >= 0) {
+        level_zero->self_scores_hist.addTo(hist, scale);
+    }
+    return range;
+}
+
+double FenwickRankTree::getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const {
+    LevelRange range = getLevelRange(lower, upper, score);  // O(log(max_level))
+    if(range.players == 0) {
+        return -1;
+    }
+    return 100 * double(range.players_with_score) / range.players;
+}
+
+/********************************** AVERAGE HIGHEST FUNCTIONS **********************************/
+double FenwickRankTree::averageHighestPlayerLevelByGroup(int m) const {
+    return double(sumHighestPlayerLevels(m)) / m;
+}
+
+long long FenwickRankTree::sumHighestPlayerLevels(int m) const {
+    int in_tree = prefixCount(max_level);
+    long long total = prefixSum(max_level);
+    if(m <= 0) {
+        return 0;
+    }
+    if(m >= in_tree) {
+        return total;  // the rest of the players are in level zero
+    }
+    long long lowest = 0;
+    findLowest(in_tree - m, &lowest);  // O(log(max_level))
+    return total - lowest;
+}
+
+int FenwickRankTree::selectLevel(int k) const {
+    int in_tree = prefixCount(max_level);
+    if(k > in_tree) {
+        return 0;  // the player is in level zero
+    }
+    return findLowest(in_tree - k + 1, nullptr);  // O(log(max_level))
+}
+
+void FenwickRankTree::getPlayersBounds(int score, int m, int* lower, int* upper) const {
+    if(score < 0 || score >= scale || m <= 0) {
+        return;
+    }
+    int in_tree = prefixCount(max_level);
+    int total_at_score = prefixAtScore(max_level, score);
+    if(m <= in_tree) {
+        // everyone above the level of the m-th highest player is taken, and some of the players in that level
+        int cut = selectLevel(m);
+        int upto = prefixCount(cut);
+        int above = in_tree - upto;
+        int at_cut = upto - prefixCount(cut-1);
+        int score_upto = prefixAtScore(cut, score);
+        int score_above = total_at_score - score_upto;
+        int score_at_cut = score_upto - prefixAtScore(cut-1, score);
+        int needed = m - above;
+        *lower += score_above + max(0, needed - (at_cut - score_at_cut));
+        *upper += score_above + min(needed, score_at_cut);
+        return;
+    }
+    // all the players in the tree, and the rest from level zero
+    int remaining = m - in_tree;
+    int zero_at_score = level_zero->self_scores_hist.get(score);
+    *lower += total_at_score + max(0, remaining - (level_zero->players_in_level - zero_at_score));
+    *upper += total_at_score + min(remaining, zero_at_score);
+}
+
+/********************************** INTERFACE FUNCTIONS **********************************/
+FenwickRankTree::FenwickRankTree(int scale, int max_level) :
+    scale(scale), max_level(max_level), counts(Arena::newArray<int>(max_level+1)), sums(Arena::newArray<long long>(max_level+1)),
+    hists(Arena::newArray<int>((max_level+1) * scale)), level_zero(Arena::makeShared<TreeNode>(scale, 0)) { }
+
+FenwickRankTree::~FenwickRankTree() {
+    clear();
+}
+
+int FenwickRankTree::getPlayersInTree() const {
+    return prefixCount(max_level) + level_zero->players_in_level;
+}
+
+void FenwickRankTree::insert(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level++;
+        level_zero->self_scores_hist.increase(player->score, 1, scale);
+        return;
+    }
+    if(player->level > max_level) {
+        return;  // outside of the domain, the manager caps the levels at max_level
+    }
+    update(player->level, player->score, 1);  // O(log(max_level))
+}
+
+void FenwickRankTree::removePlayer(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level--;
+        level_zero->self_scores_hist.increase(player->score, -1, scale);
+        return;
+    }
+    if(player->level > max_level) {
+        return;
+    }
+    update(player->level, player->score, -1);  // O(log(max_level))
+}
+
+void FenwickRankTree::change_player_score(const int level, const int old_score, const int new_score) {
+    if(level == 0) {
+        level_zero->self_scores_hist.increase(old_score, -1, scale);
+        level_zero->self_scores_hist.increase(new_score, 1, scale);
+        return;
+    }
+    if(level > max_level) {
+        return;
+    }
+    for(int i = level; i <= max_level; i += i & -i) {  // O(log(max_level)), the counts and sums don't change
+        hists[i*scale + old_score]--;
+        hists[i*scale + new_score]++;
+    }
+}
+
+void FenwickRankTree::movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level) {
+    reinsertPlayer(*this, player, old_level, new_level);  // O(logn)
+}
@@ -0,0 +1,63 @@
+#ifndef FENWICK_RANKTREE_H
+#define FENWICK_RANKTREE_H
+#include "RankTree.h"
+#include "Player.h"
+#include <memory>
+
+// the most counters (max_level+1)*scale a FenwickRankTree may hold, 128MB of histograms
+const long long MAX_FENWICK_COUNTERS = 1LL << 25;
+
+// A RankTree with the same operations for a bounded level domain 1..max_level (level 0 is kept outside like in
+// RankTree), built as Fenwick trees over the levels: one of player counts, one of level sums and one of score
+// histograms stored as max_level+1 contiguous rows of scale counters.
+// Insert, remove and score change touch O(log(max_level)) counters, range queries are two prefix walks and
+// order statistics use binary lifting, all without rotations or pointers. The price is O(max_level*scale) memory
+// however few players the tree holds, so it is only used for the tree of all the players (see
+// BoundedPlayersManager) and has no merge.
+class FenwickRankTree {
+    private:
+        static int min(const int a, const int b);
+        static int max(const int a, const int b);
+        void update(const int level, const int score, const int count);
+        int prefixCount(int level) const;
+        long long prefixSum(int level) const;
+        int prefixAtScore(int level, const int score) const;
+        int findLowest(int k, long long* sum) const;
+        void clear();
+
+    public:
+        int scale;
+        int max_level;
+        int* counts;  // Fenwick trees, index i covers the levels (i - lowbit(i), i]
+        long long* sums;
+        int* hists;
+        std::shared_ptr<TreeNode> level_zero;  // only its self counts are used
+
+        FenwickRankTree(int scale, int max_level);
+        ~FenwickRankTree();
+        FenwickRankTree(const FenwickRankTree&) = delete;
+        FenwickRankTree& operator=(const FenwickRankTree&) = delete;
+
+        int getPlayersInTree() const;
+
+        void insert(std::shared_ptr<Player>& player);
+        void removePlayer(std::shared_ptr<Player>& player);
+        LevelRange getLevelRange(const int lower, const int upper, const int score) const;
+        LevelRange getScoreDistribution(const int lower, const int upper, int* hist) const;
+        double getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const;
+        double averageHighestPlayerLevelByGroup(int m) const;
+        long long sumHighestPlayerLevels(int m) const;
+        int selectLevel(int k) const;
+
+        void change_player_score(const int level, const int old_score, const int new_score);
+        void movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level);
+
+        void getPlayersBounds(int score, int m, int* lower, int* higher) const;
+};
+
+template<>
+inline std::shared_ptr<FenwickRankTree> makeRankTree<FenwickRankTree>(int scale, int max_level) {
+    return Arena::makeShared<FenwickRankTree>(scale, max_level);
+}
+
+#endif
@@ -1,29 +1,124 @@
 #ifndef LEVEL_H
-#define LEVEL_H 
+#define LEVEL_H
 #include "RankTree.h"
+#include "Array.h"
 #include <memory>
 
+// a RankTree waiting to be merged into the tree of the group it was united with
+template<class Tree>
+struct PendingMerge {
+    std::shared_ptr<Tree> rt;
+    std::shared_ptr<PendingMerge> next;
+    PendingMerge(const std::shared_ptr<Tree>& rt, const std::shared_ptr<PendingMerge>& next) : rt(rt), next(next) { }
+};
+
+// A group's RankTree is only allocated once the first player is added to it (see getRankTree),
+// so Init(k) costs O(k) small structs instead of k full trees. An empty group has no tree and no pending merges.
+// Merging groups only records the absorbed trees in a pending list, they are merged all at once the first time
+// the group's tree is accessed. Tree is RankTree or any engine with the same interface (see PlayersManager).
+template<class Tree>
 struct Group {
-    std::shared_ptr<RankTree> rt;
+    std::shared_ptr<Tree> rt;
+    std::shared_ptr<PendingMerge<Tree>> pending;
+    PendingMerge<Tree>* pending_tail;
+    int number_of_pending;
     int groupID;
     int number_of_players;
+    int scale;
+    int max_level;
 
-    Group() : rt(nullptr), groupID(0), number_of_players(0) { }
-    Group(int groupID, int scale) : rt(std::make_shared<RankTree>(scale)), groupID(groupID), number_of_players(0) { }
+    Group() : rt(nullptr), pending(nullptr), pending_tail(nullptr), number_of_pending(0), groupID(0), number_of_players(0), scale(0), max_level(0) { }
+    Group(int groupID, int scale, int max_level) :
+        rt(nullptr), pending(nullptr), pending_tail(nullptr), number_of_pending(0), groupID(groupID), number_of_players(0), scale(scale),
+        max_level(max_level) { }
 
     ~Group() {
+        clearPending();
         rt.reset();
     }
 
-    void merge(const Group& other) {
-        // rt = std::shared_ptr<RankTree>(&RankTree::merge(*rt, *other.rt));
-        const RankTree& test = *rt;
-        rt = std::shared_ptr<RankTree>(RankTree::merge(test, *other.rt));
+    bool isEmpty() const {
+        return !rt && !pending;
+    }
+
+    Tree& getRankTree() {
+        if(pending) {
+            applyPendingMerges();
+        }
+        if(!rt) {
+            rt = makeRankTree<Tree>(scale, max_level);
+        }
+        return *rt;
+    }
+
+    // O(1), the trees are merged by the next getRankTree
+    void merge(Group& other) {
         number_of_players += other.number_of_players;
+        other.number_of_players = 0;
+        if(other.isEmpty()) {
+            return;
+        }
+        if(isEmpty()) {  // nothing to merge, take over the other group's trees
+            rt = std::move(other.rt);
+            pending = std::move(other.pending);
+            pending_tail = other.pending_tail;
+            number_of_pending = other.number_of_pending;
+        }
+        else {
+            if(other.rt) {
+                addPending(other.rt);
+            }
+            if(other.pending) {
+                if(pending) {
+                    pending_tail->next = std::move(other.pending);
+                }
+                else {
+                    pending = std::move(other.pending);
+                }
+                pending_tail = other.pending_tail;
+                number_of_pending += other.number_of_pending;
+            }
+        }
+        other.rt.reset();
+        other.pending = nullptr;
+        other.pending_tail = nullptr;
+        other.number_of_pending = 0;
     }
-    
 
+    private:
+        void addPending(const std::shared_ptr<Tree>& tree) {
+            std::shared_ptr<PendingMerge<Tree>> node = Arena::makeShared<PendingMerge<Tree>>(tree, nullptr);
+            if(pending) {
+                pending_tail->next = node;
+            }
+            else {
+                pending = node;
+            }
+            pending_tail = node.get();
+            number_of_pending++;
+        }
+
+        void clearPending() {
+            // iterative so that long merge chains don't release the list recursively
+            while(pending) {
+                pending = pending->next;
+            }
+            pending_tail = nullptr;
+            number_of_pending = 0;
+        }
+
+        void applyPendingMerges() {
+            Array<std::shared_ptr<Tree>> trees(number_of_pending + (rt ? 1 : 0));
+            if(rt) {
+                trees.push_back(rt);
+            }
+            for(PendingMerge<Tree>* it = pending.get(); it; it = it->next.get()) {
+                trees.push_back(it->rt);
+            }
+            clearPending();
+            rt = Tree::merge(trees);  // O(n*scale)
+        }
 };
 
 
-#endif
\ No newline at end of file
+#endif
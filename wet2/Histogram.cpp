@@ -0,0 +1,240 @@
+#include "Histogram.h"
+
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+long long histogram_updates = 0;
+long long histogram_rebuilds = 0;
+#endif
+
+/********************************** PORTABLE KERNELS **********************************/
+
+static void add_portable(int* dst, const int* src, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+static void subtract_portable(int* dst, const int* src, int n) {
+    for(int i = 0; i < n; ++i) {
+        int diff = dst[i] - src[i];
+        dst[i] = (diff > 0) ? diff : 0;
+    }
+}
+
+static void reset_portable(int* dst, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] = 0;
+    }
+}
+
+static void copy_portable(int* dst, const int* src, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+static void sum_portable(int* dst, const int* self, const int* left, const int* right, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] = self[i] + left[i] + right[i];
+    }
+}
+
+/********************************** X86 KERNELS **********************************/
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define HISTOGRAM_X86
+#include <immintrin.h>
+
+__attribute__((target("sse4.1")))
+static void add_sse4(int* dst, const int* src, int n) {
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(a, b));
+    }
+    add_portable(dst + i, src + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void subtract_sse4(int* dst, const int* src, int n) {
+    int i = 0;
+    __m128i zero = _mm_setzero_si128();
+    for(; i + 4 <= n; i += 4) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_max_epi32(_mm_sub_epi32(a, b), zero));
+    }
+    subtract_portable(dst + i, src + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void reset_sse4(int* dst, int n) {
+    int i = 0;
+    __m128i zero = _mm_setzero_si128();
+    for(; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), zero);
+    }
+    reset_portable(dst + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void copy_sse4(int* dst, const int* src, int n) {
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_loadu_si128((const __m128i*)(src + i)));
+    }
+    copy_portable(dst + i, src + i, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static void sum_sse4(int* dst, const int* self, const int* left, const int* right, int n) {
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(self + i));
+        __m128i l = _mm_loadu_si128((const __m128i*)(left + i));
+        __m128i r = _mm_loadu_si128((const __m128i*)(right + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_add_epi32(_mm_add_epi32(s, l), r));
+    }
+    sum_portable(dst + i, self + i, left + i, right + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void add_avx2(int* dst, const int* src, int n) {
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(a, b));
+    }
+    _mm256_zeroupper();  // the tail is legacy SSE code, which stalls on dirty upper halves
+    add_sse4(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void subtract_avx2(int* dst, const int* src, int n) {
+    int i = 0;
+    __m256i zero = _mm256_setzero_si256();
+    for(; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_max_epi32(_mm256_sub_epi32(a, b), zero));
+    }
+    _mm256_zeroupper();  // the tail is legacy SSE code, which stalls on dirty upper halves
+    subtract_sse4(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void reset_avx2(int* dst, int n) {
+    int i = 0;
+    __m256i zero = _mm256_setzero_si256();
+    for(; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), zero);
+    }
+    _mm256_zeroupper();  // the tail is legacy SSE code, which stalls on dirty upper halves
+    reset_sse4(dst + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void copy_avx2(int* dst, const int* src, int n) {
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_loadu_si256((const __m256i*)(src + i)));
+    }
+    _mm256_zeroupper();  // the tail is legacy SSE code, which stalls on dirty upper halves
+    copy_sse4(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void sum_avx2(int* dst, const int* self, const int* left, const int* right, int n) {
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(self + i));
+        __m256i l = _mm256_loadu_si256((const __m256i*)(left + i));
+        __m256i r = _mm256_loadu_si256((const __m256i*)(right + i));
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_add_epi32(_mm256_add_epi32(s, l), r));
+    }
+    _mm256_zeroupper();  // the tail is legacy SSE code, which stalls on dirty upper halves
+    sum_sse4(dst + i, self + i, left + i, right + i, n - i);
+}
+#endif
+
+/********************************** DISPATCH **********************************/
+
+struct HistogramKernels {
+    void (*add)(int*, const int*, int);
+    void (*subtract)(int*, const int*, int);
+    void (*reset)(int*, int);
+    void (*copy)(int*, const int*, int);
+    void (*sum)(int*, const int*, const int*, const int*, int);
+    const char* name;
+};
+
+static HistogramKernels selectKernels() {
+#ifdef HISTOGRAM_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")) {
+        return { add_avx2, subtract_avx2, reset_avx2, copy_avx2, sum_avx2, "avx2" };
+    }
+    if(__builtin_cpu_supports("sse4.1")) {
+        return { add_sse4, subtract_sse4, reset_sse4, copy_sse4, sum_sse4, "sse4.1" };
+    }
+#endif
+    return { add_portable, subtract_portable, reset_portable, copy_portable, sum_portable, "portable" };
+}
+
+static const HistogramKernels& kernels() {
+    static const HistogramKernels selected = selectKernels();
+    return selected;
+}
+
+void Histogram::add(int* dst, const int* src, int n) {
+    if(!dst || !src) {
+        return;
+    }
+    COUNT_HISTOGRAM_REBUILD();
+    kernels().add(dst, src, n);
+}
+
+void Histogram::subtract(int* dst, const int* src, int n) {
+    if(!dst || !src) {
+        return;
+    }
+    COUNT_HISTOGRAM_REBUILD();
+    kernels().subtract(dst, src, n);
+}
+
+void Histogram::reset(int* dst, int n) {
+    COUNT_HISTOGRAM_REBUILD();
+    kernels().reset(dst, n);
+}
+
+void Histogram::copy(int* dst, const int* src, int n) {
+    COUNT_HISTOGRAM_REBUILD();
+    if(!src) {
+        kernels().reset(dst, n);
+        return;
+    }
+    kernels().copy(dst, src, n);
+}
+
+void Histogram::sum(int* dst, const int* self, const int* left, const int* right, int n) {
+    if(self && left && right) {
+        COUNT_HISTOGRAM_REBUILD();
+        kernels().sum(dst, self, left, right, n);
+        return;
+    }
+    // some sources are missing, copy the first one and add the rest pairwise
+    const int* sources[3] = {self, left, right};
+    int first = 0;
+    while(first < 2 && !sources[first]) {
+        first++;
+    }
+    copy(dst, sources[first], n);
+    for(int i = first+1; i < 3; ++i) {
+        add(dst, sources[i], n);
+    }
+}
+
+const char* Histogram::implementation() {
+    return kernels().name;
+}
@@ -0,0 +1,43 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+// Kernels for the score histograms kept in every RankTree node.
+// The implementation is picked once at startup: AVX2 or SSE4.1 when the cpu supports them (x86 with gcc/clang),
+// a portable loop otherwise. All functions work on histograms of n ints, nullptr sources count as all zeros.
+class Histogram {
+    public:
+        // dst += src
+        static void add(int* dst, const int* src, int n);
+        // dst = max(0, dst - src)
+        static void subtract(int* dst, const int* src, int n);
+        // dst = 0
+        static void reset(int* dst, int n);
+        // dst = src
+        static void copy(int* dst, const int* src, int n);
+        // dst = self + left + right, replaces reset followed by three adds
+        static void sum(int* dst, const int* self, const int* left, const int* right, int n);
+
+        // name of the selected implementation ("avx2", "sse4.1" or "portable")
+        static const char* implementation();
+};
+
+// build with -DWET2_COUNT_HISTOGRAM_UPDATES to count the histogram work of the RankTree engines in two counters,
+// see bench/move_bench.cpp and bench/engine_bench.cpp:
+//   histogram_updates:  single score counters changed. ScoreHistogram::increase, InlineHistogram::increase, the
+//                       score counters of the BPlusRankTree rows and the nodes of the per score LevelIndexes of
+//                       ScoreIndexRankTree
+//   histogram_rebuilds: passes over a whole histogram, the Histogram kernels and the loops of InlineHistogram
+// the counters aren't atomic, only single threaded counts are exact
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+extern long long histogram_updates;
+extern long long histogram_rebuilds;
+#define COUNT_HISTOGRAM_UPDATE() (++histogram_updates)
+#define COUNT_HISTOGRAM_UPDATES(n) (histogram_updates += (n))
+#define COUNT_HISTOGRAM_REBUILD() (++histogram_rebuilds)
+#else
+#define COUNT_HISTOGRAM_UPDATE()
+#define COUNT_HISTOGRAM_UPDATES(n) ((void)(n))
+#define COUNT_HISTOGRAM_REBUILD()
+#endif
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef INLINE_HISTOGRAM_H
+#define INLINE_HISTOGRAM_H
+
+#include "Histogram.h"
+#include <array>
+
+// The score histogram of a RankTree node when the width is known at compile time (see BasicRankTree).
+// The Width counters are kept inside the node as a std::array, and every loop runs over the constant Width, so the
+// compiler unrolls and vectorizes it for the exact size. Same interface as ScoreHistogram, the scale arguments are
+// only used where the histogram is added to an array of scale counters that belongs to the caller.
+template<int Width>
+class InlineHistogram {
+    private:
+        std::array<int, Width> counts;
+
+    public:
+        InlineHistogram() {
+            counts.fill(0);
+        }
+
+        bool isDense() const {
+            return true;
+        }
+
+        int get(int score) const {
+            return counts[score];
+        }
+
+        void increase(int score, int count, int) {
+            COUNT_HISTOGRAM_UPDATE();
+            counts[score] += count;
+        }
+
+        // this += other
+        void add(const InlineHistogram& other, int) {
+            COUNT_HISTOGRAM_REBUILD();
+            for(int i = 0; i < Width; ++i) {
+                counts[i] += other.counts[i];
+            }
+        }
+
+        // this = max(0, this - other)
+        void subtract(const InlineHistogram& other, int) {
+            COUNT_HISTOGRAM_REBUILD();
+            for(int i = 0; i < Width; ++i) {
+                int diff = counts[i] - other.counts[i];
+                counts[i] = (diff > 0) ? diff : 0;
+            }
+        }
+
+        // this = self + left + right, nullptr children count as empty
+        void sum(const InlineHistogram& self, const InlineHistogram* left, const InlineHistogram* right, int) {
+            COUNT_HISTOGRAM_REBUILD();
+            if(left && right) {
+                for(int i = 0; i < Width; ++i) {
+                    counts[i] = self.counts[i] + left->counts[i] + right->counts[i];
+                }
+            }
+            else if(left || right) {
+                const InlineHistogram* child = left ? left : right;
+                for(int i = 0; i < Width; ++i) {
+                    counts[i] = self.counts[i] + child->counts[i];
+                }
+            }
+            else {
+                counts = self.counts;
+            }
+        }
+
+        // this = other
+        void copy(const InlineHistogram& other, int) {
+            COUNT_HISTOGRAM_REBUILD();
+            counts = other.counts;
+        }
+
+        // this = 0
+        void reset() {
+            COUNT_HISTOGRAM_REBUILD();
+            counts.fill(0);
+        }
+
+        // hist += this, hist is a dense array of scale counters (scale <= Width)
+        void addTo(int* hist, int scale) const {
+            COUNT_HISTOGRAM_REBUILD();
+            for(int i = 0; i < scale; ++i) {
+                hist[i] += counts[i];
+            }
+        }
+
+        void swap(InlineHistogram& other) {
+            counts.swap(other.counts);
+        }
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "LevelIndex.h"
+
+/********************************** HELPER FUNCTIONS **********************************/
+int LevelIndex::height(const std::shared_ptr<LevelCountNode>& root) {
+    if(!root) {
+        return -1;
+    }
+    return root->height;
+}
+
+int LevelIndex::getCount(const std::shared_ptr<LevelCountNode>& root) {
+    if(!root) {
+        return 0;
+    }
+    return root->count_in_subtree;
+}
+
+long long LevelIndex::getSum(const std::shared_ptr<LevelCountNode>& root) {
+    if(!root) {
+        return 0;
+    }
+    return root->sum_levels_in_subtree;
+}
+
+void LevelIndex::update(std::shared_ptr<LevelCountNode>& root) {
+    int left = height(root->left), right = height(root->right);
+    root->height = 1 + ((left > right) ? left : right);
+    root->count_in_subtree = root->count + getCount(root->left) + getCount(root->right);
+    root->sum_levels_in_subtree = (long long)root->level_id * root->count + getSum(root->left) + getSum(root->right);
+}
+
+void LevelIndex::rotateLeft(std::shared_ptr<LevelCountNode>& root) {
+    std::shared_ptr<LevelCountNode> child = root->right;
+    root->right = child->left;
+    update(root);
+    child->left = root;
+    update(child);
+    root = child;
+}
+
+void LevelIndex::rotateRight(std::shared_ptr<LevelCountNode>& root) {
+    std::shared_ptr<LevelCountNode> child = root->left;
+    root->left = child->right;
+    update(root);
+    child->right = root;
+    update(child);
+    root = child;
+}
+
+void LevelIndex::balance(std::shared_ptr<LevelCountNode>& root) {
+    if(!root) {
+        return;
+    }
+    update(root);
+    int balance_factor = height(root->left) - height(root->right);
+    if(balance_factor > 1) {
+        if(height(root->left->left) < height(root->left->right)) {
+            rotateLeft(root->left);  // LR
+        }
+        rotateRight(root);
+    }
+    else if(balance_factor < -1) {
+        if(height(root->right->right) < height(root->right->left)) {
+            rotateRight(root->right);  // RL
+        }
+        rotateLeft(root);
+    }
+}
+
+/********************************** UPDATE FUNCTIONS **********************************/
+std::shared_ptr<LevelCountNode> LevelIndex::detachMin(std::shared_ptr<LevelCountNode>& root) {
+    if(!root->left) {
+        std::shared_ptr<LevelCountNode> min = root;
+        root = root->right;
+        return min;
+    }
+    std::shared_ptr<LevelCountNode> min = detachMin(root->left);
+    balance(root);
+    return min;
+}
+
+void LevelIndex::removeNode(std::shared_ptr<LevelCountNode>& root) {
+    if(!root->left) {
+        root = root->right;
+        return;
+    }
+    if(!root->right) {
+        root = root->left;
+        return;
+    }
+    // replace the node with its successor
+    std::shared_ptr<LevelCountNode> right = root->right;
+    std::shared_ptr<LevelCountNode> successor = detachMin(right);
+    successor->left = root->left;
+    successor->right = right;
+    root = successor;
+    balance(root);
+}
+
+void LevelIndex::addAux(std::shared_ptr<LevelCountNode>& root, const int level_id, const int count, int* levels_delta, int* path) {
+    if(!root) {
+        if(count > 0) {
+            root = Arena::makeShared<LevelCountNode>(level_id, count);
+            *levels_delta = 1;
+            (*path)++;
+        }
+        return;
+    }
+    (*path)++;
+    if(level_id < root->level_id) {
+        addAux(root->left, level_id, count, levels_delta, path);
+    }
+    else if(root->level_id < level_id) {
+        addAux(root->right, level_id, count, levels_delta, path);
+    }
+    else {
+        root->count += count;
+        if(root->count <= 0) {
+            removeNode(root);
+            *levels_delta = -1;
+            return;  // the subtree that replaced the node is already up to date
+        }
+    }
+    balance(root);
+}
+
+int LevelIndex::add(const int level_id, const int count) {
+    int levels_delta = 0, path = 0;
+    addAux(root, level_id, count, &levels_delta, &path);  // O(logn)
+    number_of_levels += levels_delta;
+    return path;
+}
+
+/********************************** QUERY FUNCTIONS **********************************/
+int LevelIndex::total() const {
+    return getCount(root);
+}
+
+int LevelIndex::height() const {
+    return height(root);
+}
+
+int LevelIndex::countAt(const int level_id) const {
+    const LevelCountNode* node = root.get();
+    while(node && node->level_id != level_id) {
+        node = (level_id < node->level_id) ? node->left.get() : node->right.get();
+    }
+    return node ? node->count : 0;
+}
+
+int LevelIndex::countAtMost(const int level_id) const {
+    int count = 0;
+    const LevelCountNode* node = root.get();
+    while(node) {
+        if(node->level_id <= level_id) {
+            count += getCount(node->left) + node->count;
+            node = node->right.get();
+        }
+        else {
+            node = node->left.get();
+        }
+    }
+    return count;
+}
+
+long long LevelIndex::sumAtMost(const int level_id) const {
+    long long sum = 0;
+    const LevelCountNode* node = root.get();
+    while(node) {
+        if(node->level_id <= level_id) {
+            sum += getSum(node->left) + (long long)node->level_id * node->count;
+            node = node->right.get();
+        }
+        else {
+            node = node->left.get();
+        }
+    }
+    return sum;
+}
+
+// sum of the m highest levels, counting every unit of a level's count
+long long LevelIndex::sumHighest(int m) const {
+    long long sum = 0;
+    const LevelCountNode* node = root.get();
+    while(node && m > 0) {
+        int right = getCount(node->right);
+        if(right >= m) {
+            node = node->right.get();
+            continue;
+        }
+        sum += getSum(node->right);
+        m -= right;
+        if(node->count >= m) {
+            return sum + (long long)m * node->level_id;
+        }
+        sum += (long long)node->count * node->level_id;
+        m -= node->count;
+        node = node->left.get();
+    }
+    return sum;
+}
+
+// the level of the k-th highest unit, 0 if there are less than k
+int LevelIndex::select(int k) const {
+    const LevelCountNode* node = root.get();
+    while(node) {
+        int right = getCount(node->right);
+        if(right >= k) {
+            node = node->right.get();
+            continue;
+        }
+        k -= right;
+        if(node->count >= k) {
+            return node->level_id;
+        }
+        k -= node->count;
+        node = node->left.get();
+    }
+    return 0;
+}
+
+/********************************** MERGE FUNCTIONS **********************************/
+void LevelIndex::inorderToList(const std::shared_ptr<LevelCountNode>& root, Array<LevelCount>& list) {
+    if(!root) {
+        return;
+    }
+    inorderToList(root->left, list);
+    list.push_back(LevelCount(root->level_id, root->count));
+    inorderToList(root->right, list);
+}
+
+Array<LevelCount> LevelIndex::getAsList() const {
+    Array<LevelCount> list(number_of_levels);
+    inorderToList(root, list);  // O(n)
+    return list;
+}
+
+std::shared_ptr<LevelCountNode> LevelIndex::buildAux(const Array<LevelCount>& list, int start, int end) {
+    if(start > end) {
+        return nullptr;
+    }
+    int mid = (start+end)/2;
+    std::shared_ptr<LevelCountNode> root = Arena::makeShared<LevelCountNode>(list[mid].level_id, list[mid].count);
+    root->left = buildAux(list, start, mid-1);
+    root->right = buildAux(list, mid+1, end);
+    update(root);
+    return root;
+}
+
+void LevelIndex::buildFromList(const Array<LevelCount>& list) {
+    int size = list.getSize()+1;
+    int distinct = 0;
+    for(int i = 0; i < size; ++i) {
+        distinct += (i == 0 || list[i].level_id != list[i-1].level_id);
+    }
+    Array<LevelCount> combined(distinct);
+    for(int i = 0; i < size; ) {
+        LevelCount level = list[i++];
+        while(i < size && list[i].level_id == level.level_id) {
+            level.count += list[i++].count;
+        }
+        combined.push_back(level);
+    }
+    root = buildAux(combined, 0, distinct-1);  // O(n)
+    number_of_levels = distinct;
+}
+
+void LevelIndex::clear() {
+    root = nullptr;
+    number_of_levels = 0;
+}
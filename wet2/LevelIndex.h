@@ -0,0 +1,68 @@
+#ifndef LEVEL_INDEX_H
+#define LEVEL_INDEX_H
+#include "Array.h"
+#include <memory>
+
+struct LevelCountNode {
+    int level_id;
+    int height;
+    int count;  // players in the level
+    int count_in_subtree;
+    long long sum_levels_in_subtree;
+    std::shared_ptr<LevelCountNode> left;
+    std::shared_ptr<LevelCountNode> right;
+
+    LevelCountNode(int level_id, int count) :
+        level_id(level_id), height(0), count(count), count_in_subtree(count), sum_levels_in_subtree((long long)level_id * count),
+        left(nullptr), right(nullptr) { }
+};
+
+// a level and its count, used to move an index to a list and back
+struct LevelCount {
+    int level_id;
+    int count;
+
+    LevelCount(int level_id=0, int count=0) : level_id(level_id), count(count) { }
+};
+
+// An AVL tree of levels that keeps a single count per level and the counts and level sums of every subtree,
+// so prefix counts, prefix sums and order statistics are O(logn). A level is removed when its count drops to 0.
+class LevelIndex {
+    private:
+        static int height(const std::shared_ptr<LevelCountNode>& root);
+        static int getCount(const std::shared_ptr<LevelCountNode>& root);
+        static long long getSum(const std::shared_ptr<LevelCountNode>& root);
+        static void update(std::shared_ptr<LevelCountNode>& root);
+        static void rotateLeft(std::shared_ptr<LevelCountNode>& root);
+        static void rotateRight(std::shared_ptr<LevelCountNode>& root);
+        static void balance(std::shared_ptr<LevelCountNode>& root);
+        static std::shared_ptr<LevelCountNode> detachMin(std::shared_ptr<LevelCountNode>& root);
+        static void removeNode(std::shared_ptr<LevelCountNode>& root);
+        static void addAux(std::shared_ptr<LevelCountNode>& root, const int level_id, const int count, int* levels_delta, int* path);
+        static void inorderToList(const std::shared_ptr<LevelCountNode>& root, Array<LevelCount>& list);
+        static std::shared_ptr<LevelCountNode> buildAux(const Array<LevelCount>& list, int start, int end);
+
+    public:
+        std::shared_ptr<LevelCountNode> root;
+        int number_of_levels = 0;
+
+        LevelIndex() : root(nullptr), number_of_levels(0) { }
+
+        int total() const;
+        int height() const;
+        // count may be negative, the level is created or removed as needed. returns the number of nodes on the path
+        // to the level, whose counts were updated
+        int add(const int level_id, const int count);
+        int countAt(const int level_id) const;
+        int countAtMost(const int level_id) const;
+        long long sumAtMost(const int level_id) const;
+        long long sumHighest(int m) const;
+        int select(int k) const;
+
+        Array<LevelCount> getAsList() const;
+        // replaces the index with a sorted list of levels, equal levels are combined
+        void buildFromList(const Array<LevelCount>& list);
+        void clear();
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <exception>
+#include <memory>
+#include <thread>
+#include "Arena.h"
+
+// Minimal fork-join helpers for the linear merges of large trees. Work is split into as many chunks as there are
+// threads and every chunk runs on its own std::thread (the first on the calling thread), so there is no shared queue
+// to contend on. If a thread can't be started its chunk runs on the calling thread, and an exception thrown by a
+// chunk (e.g. bad_alloc) is rethrown on the calling thread after the join. The threads allocate from the arena of
+// the calling thread.
+class Parallel {
+    private:
+        static int& threadsSetting() {
+            static int threads = 0;  // 0 means one thread per hardware thread
+            return threads;
+        }
+
+        // the arrays of forEachChunk. each member frees its array, so neither leaks if the other allocation throws
+        struct ChunkSlots {
+            std::unique_ptr<std::exception_ptr[]> errors;
+            std::unique_ptr<std::thread[]> workers;
+
+            explicit ChunkSlots(int chunks) : errors(new std::exception_ptr[chunks]), workers(new std::thread[chunks-1]) { }
+        };
+
+    public:
+        // the number of threads a parallel section may use, 1 runs everything serially
+        static int threads() {
+            int threads = threadsSetting();
+            if(threads <= 0) {
+                threads = (int)std::thread::hardware_concurrency();
+            }
+            return (threads > 0) ? threads : 1;
+        }
+
+        // overrides the hardware concurrency, 0 restores it. not thread safe, call before using the structure
+        static void setThreads(int threads) {
+            threadsSetting() = threads;
+        }
+
+        // runs job(0) .. job(chunks-1) in parallel and waits for all of them
+        template<class Job>
+        static void forEachChunk(int chunks, const Job& job) {
+            if(chunks <= 1) {
+                if(chunks == 1) {
+                    job(0);
+                }
+                return;
+            }
+            ChunkSlots slots(chunks);
+            std::exception_ptr* errors = slots.errors.get();
+            std::thread* workers = slots.workers.get();
+            int started = 0;
+            Arena* arena = Arena::current();
+            if(arena) {
+                arena->beginShared();
+            }
+            try {
+                for(; started < chunks-1; ++started) {
+                    int chunk = started+1;
+                    workers[started] = std::thread([&job, errors, chunk, arena]() {
+                        ArenaScope scope(arena);
+                        try {
+                            job(chunk);
+                        }
+                        catch(...) {
+                            errors[chunk] = std::current_exception();
+                        }
+                    });
+                }
+            }
+            catch(...) { }  // could not start another thread, the remaining chunks run on this one
+            for(int chunk = started+1; chunk <= chunks; ++chunk) {
+                int current = chunk % chunks;  // chunk 0 last
+                try {
+                    job(current);
+                }
+                catch(...) {
+                    errors[current] = std::current_exception();
+                }
+            }
+            for(int i = 0; i < started; ++i) {
+                workers[i].join();
+            }
+            if(arena) {
+                arena->endShared();
+            }
+            std::exception_ptr error = nullptr;
+            for(int i = 0; i < chunks && !error; ++i) {
+                error = errors[i];
+            }
+            if(error) {
+                std::rethrow_exception(error);
+            }
+        }
+
+        // runs first on a new thread and second on the calling thread, or both serially if parallel is false
+        template<class First, class Second>
+        static void invoke(bool parallel, const First& first, const Second& second) {
+            if(!parallel) {
+                first();
+                second();
+                return;
+            }
+            forEachChunk(2, [&first, &second](int chunk) {
+                if(chunk == 1) {
+                    first();
+                }
+                else {
+                    second();
+                }
+            });
+        }
+};
+
+#endif
@@ -6,9 +6,10 @@ struct Player {
     int groupID;
     int score;
     int level;
+    unsigned long long handle;  // the player's handle in the manager's HandleTable, 0 if none was given out
 
     Player(int playerID=0, int groupID=0, int score=0, int level=0) : 
-        playerID(playerID), groupID(groupID), score(score), level(level) { }
+        playerID(playerID), groupID(groupID), score(score), level(level), handle(0) { }
 };
 
 #endif
\ No newline at end of file
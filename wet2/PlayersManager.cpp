@@ -4,55 +4,93 @@
 #include <exception>
 #include <iostream>
 
-PlayersManager::PlayersManager(int k, int scale) : groups(k, scale+1), all_players_tree(scale+1), all_players(), scale(scale) { }  // O(k)
+template<class Tree, class AllTree>
+BasicPlayersManager<Tree, AllTree>::BasicPlayersManager(int k, int scale, int max_level) :
+    groups(k, scale+1, max_level), all_players_tree(makeRankTree<AllTree>(scale+1, max_level)), all_players(), handles(), scale(scale),
+    max_level(max_level) { }  // O(k), group trees are allocated lazily
 
-PMStatusType PlayersManager::mergeGroups(int GroupID1, int GroupID2) {
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::mergeGroups(int GroupID1, int GroupID2) {
+    ArenaScope scope(arena);
     if(GroupID1 <= 0 || GroupID2 <= 0 || GroupID1 > groups.Size() || GroupID2 > groups.Size()) {
         return PM_INVALID_INPUT;
     }
     int root1 = groups.Find(GroupID1-1);  // O(log*k) amortized with Union
     int root2 = groups.Find(GroupID2-1);  // O(log*k) amortized with Union
     if(root1 != root2) {
-        groups.Union(root1, root2);  // O(log*k + n) amortized with Find
+        groups.Union(root1, root2);  // O(log*k) amortized with Find, the trees are merged on the next access
     }
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::addPlayer(int PlayerID, int GroupID, int score) {
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::addPlayer(int PlayerID, int GroupID, int score, PlayerHandles::Handle* handle) {
+    ArenaScope scope(arena);
     if(GroupID <= 0 || GroupID > groups.Size() || score <= 0 || score > scale || PlayerID <= 0) {
         return PM_INVALID_INPUT;
     }
     if(all_players.findPlayer(PlayerID) != nullptr) {  // O(1) amortized with average input
         return PM_FAILURE;
     }
+    std::shared_ptr<Player> player = nullptr;
     try {
-        std::shared_ptr<Player> player = std::make_shared<Player>(PlayerID, GroupID, score, 0);
-        all_players_tree.insert(player);  // O(1)
-        all_players.addPlayer(player);  // O(1) amortized with average input
+        player = Arena::makeShared<Player>(PlayerID, GroupID, score, 0);
+        if(handle) {
+            player->handle = handles.add(player);  // O(1) amortized
+        }
         int root = groups.Find(GroupID-1);  // O(log*k) amortized with Union
-        groups.groups[root].rt->insert(player);  // O(1)
+        Tree& group_tree = groups.groups[root].getRankTree();  // O(1), allocates the tree on first player
+        all_players_tree->insert(player);  // O(1)
+        all_players.addPlayer(player);  // O(1) amortized with average input
+        group_tree.insert(player);  // O(1)
         groups.groups[root].number_of_players++;
+        if(handle) {
+            *handle = player->handle;
+        }
     }
     catch(std::bad_alloc&) {
+        if(player) {
+            handles.release(player->handle);
+        }
         return PM_ALLOCATION_ERROR;
     }
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::removePlayer(int PlayerID) {
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::removePlayer(int PlayerID) {
+    ArenaScope scope(arena);
     if(PlayerID <= 0) {
         return PM_INVALID_INPUT;
     }
-    std::shared_ptr<Player> player = all_players.findPlayer(PlayerID);
-    if(player == nullptr) {  // O(1) amortized with average input
-        return PM_FAILURE;
+    try {
+        std::shared_ptr<Player> player = all_players.tryRemovePlayer(PlayerID);  // O(1) amortized with average input
+        if(player == nullptr) {
+            return PM_FAILURE;
+        }
+        removeFromTrees(player);  // O(logn)
+        handles.release(player->handle);  // O(1)
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::removePlayerByHandle(PlayerHandles::Handle handle) {
+    ArenaScope scope(arena);
+    if(!handle) {
+        return PM_INVALID_INPUT;
     }
     try {
-        all_players.removePlayer(player);  // O(1) amortized with average input
-        all_players_tree.removePlayer(player);  // O(logn)
-        int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
-        groups.groups[root].rt->removePlayer(player);  // O(logn)
-        groups.groups[root].number_of_players--;
+        std::shared_ptr<Player> player = handles.find(handle);  // O(1)
+        if(player == nullptr) {  // the player was removed
+            return PM_FAILURE;
+        }
+        all_players.tryRemovePlayer(player->playerID);  // O(1) amortized with average input
+        removeFromTrees(player);  // O(logn)
+        handles.release(handle);  // O(1)
     }
     catch(std::bad_alloc&) {
         return PM_ALLOCATION_ERROR;
@@ -60,7 +98,17 @@ PMStatusType PlayersManager::removePlayer(int PlayerID) {
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::increasePlayerIDLevel(int PlayerID, int LevelIncrease){
+template<class Tree, class AllTree>
+void BasicPlayersManager<Tree, AllTree>::removeFromTrees(std::shared_ptr<Player>& player) {
+    all_players_tree->removePlayer(player);  // O(logn)
+    int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
+    groups.groups[root].getRankTree().removePlayer(player);  // O(logn)
+    groups.groups[root].number_of_players--;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::increasePlayerIDLevel(int PlayerID, int LevelIncrease){
+    ArenaScope scope(arena);
     if(PlayerID <= 0 || LevelIncrease <= 0) {
         return PM_INVALID_INPUT;
     }
@@ -69,14 +117,7 @@ PMStatusType PlayersManager::increasePlayerIDLevel(int PlayerID, int LevelIncrea
         return PM_FAILURE;
     }
     try {
-        all_players_tree.removePlayer(player);  // O(1) if level = 0, O(logn) otherwise
-        int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
-        groups.groups[root].rt->removePlayer(player);  // O(1) if level = 0, O(logn) otherwise
-        groups.groups[root].number_of_players--;
-        player->level += LevelIncrease;
-        all_players_tree.insert(player); // O(1) if level = 0, O(logn) otherwise
-        groups.groups[root].rt->insert(player); // O(1) if level = 0, O(logn) otherwise
-        groups.groups[root].number_of_players++;
+        increaseLevel(player, LevelIncrease);  // O(logn)
     }
     catch(std::bad_alloc&) {
         return PM_ALLOCATION_ERROR;
@@ -84,8 +125,39 @@ PMStatusType PlayersManager::increasePlayerIDLevel(int PlayerID, int LevelIncrea
     return PM_SUCCESS;
 }
 
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::increasePlayerLevelByHandle(PlayerHandles::Handle handle, int LevelIncrease) {
+    ArenaScope scope(arena);
+    if(!handle || LevelIncrease <= 0) {
+        return PM_INVALID_INPUT;
+    }
+    std::shared_ptr<Player> player = handles.find(handle);  // O(1)
+    if(player == nullptr) {  // the player was removed
+        return PM_FAILURE;
+    }
+    try {
+        increaseLevel(player, LevelIncrease);  // O(logn)
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
 
-PMStatusType PlayersManager::changePlayerIDScore(int PlayerID, int NewScore) {
+template<class Tree, class AllTree>
+void BasicPlayersManager<Tree, AllTree>::increaseLevel(std::shared_ptr<Player>& player, int LevelIncrease) {
+    int old_level = player->level;
+    long long new_level = (long long)player->level + LevelIncrease;
+    player->level = (new_level > max_level) ? max_level : (int)new_level;  // levels stay in the engine's domain
+    all_players_tree->movePlayer(player, old_level, player->level);  // O(logn)
+    int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
+    groups.groups[root].getRankTree().movePlayer(player, old_level, player->level);  // O(logn)
+}
+
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::changePlayerIDScore(int PlayerID, int NewScore) {
+    ArenaScope scope(arena);
     if(PlayerID <= 0 || NewScore <= 0 || NewScore > scale) {
         return PM_INVALID_INPUT;
     }
@@ -94,11 +166,26 @@ PMStatusType PlayersManager::changePlayerIDScore(int PlayerID, int NewScore) {
         return PM_FAILURE;
     }
     try {
-        all_players_tree.change_player_score(player->level, player->score, NewScore);
-        int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
-        groups.groups[root].rt->change_player_score(player->level, player->score, NewScore);
+        changeScore(player, NewScore);  // O(logn)
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
 
-        player->score = NewScore;
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::changePlayerScoreByHandle(PlayerHandles::Handle handle, int NewScore) {
+    ArenaScope scope(arena);
+    if(!handle || NewScore <= 0 || NewScore > scale) {
+        return PM_INVALID_INPUT;
+    }
+    std::shared_ptr<Player> player = handles.find(handle);  // O(1)
+    if(player == nullptr) {  // the player was removed
+        return PM_FAILURE;
+    }
+    try {
+        changeScore(player, NewScore);  // O(logn)
     }
     catch(std::bad_alloc&) {
         return PM_ALLOCATION_ERROR;
@@ -106,18 +193,32 @@ PMStatusType PlayersManager::changePlayerIDScore(int PlayerID, int NewScore) {
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::getPercentOfPlayersWithScoreInBounds(int GroupID, int score, int lowerlevel, int higherlevel, double* players) {
+template<class Tree, class AllTree>
+void BasicPlayersManager<Tree, AllTree>::changeScore(std::shared_ptr<Player>& player, int NewScore) {
+    all_players_tree->change_player_score(player->level, player->score, NewScore);
+    int root = groups.Find(player->groupID-1);  // O(log*k) amortized with Union
+    groups.groups[root].getRankTree().change_player_score(player->level, player->score, NewScore);
+
+    player->score = NewScore;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::getPercentOfPlayersWithScoreInBounds(int GroupID, int score, int lowerlevel, int higherlevel, double* players) {
+    ArenaScope scope(arena);
     try {
         if(GroupID < 0 || GroupID > groups.Size() || !players) {
             return PM_INVALID_INPUT;
         }
         double res;
         if(GroupID == 0) {
-            res = all_players_tree.getPercentOfPlayersWithScoreInBounds(lowerlevel, higherlevel, score);
+            res = all_players_tree->getPercentOfPlayersWithScoreInBounds(lowerlevel, higherlevel, score);
         }
         else {
             int root = groups.Find(GroupID-1);
-            res = groups.groups[root].rt->getPercentOfPlayersWithScoreInBounds(lowerlevel, higherlevel, score);
+            if(groups.groups[root].isEmpty()) {  // no players in any level
+                return PM_FAILURE;
+            }
+            res = groups.groups[root].getRankTree().getPercentOfPlayersWithScoreInBounds(lowerlevel, higherlevel, score);
         }
         if(res == -1) {  // no players in lowerlevel, upperlevel
             return PM_FAILURE;
@@ -134,23 +235,79 @@ PMStatusType PlayersManager::getPercentOfPlayersWithScoreInBounds(int GroupID, i
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::averageHighestPlayerLevelByGroup(int GroupID, int m, double* avgLevel) {
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::getScoreDistributionInBounds(int GroupID, int lowerlevel, int higherlevel, int* counts) {
+    ArenaScope scope(arena);
+    try {
+        if(GroupID < 0 || GroupID > groups.Size() || !counts) {
+            return PM_INVALID_INPUT;
+        }
+        int hist[MAX_SCORE+1];  // scores are 1..scale, hist[0] is unused
+        LevelRange range;
+        if(GroupID == 0) {
+            range = all_players_tree->getScoreDistribution(lowerlevel, higherlevel, hist);  // O(logn*scale)
+        }
+        else {
+            int root = groups.Find(GroupID-1);
+            if(groups.groups[root].isEmpty()) {  // no players in any level
+                return PM_FAILURE;
+            }
+            range = groups.groups[root].getRankTree().getScoreDistribution(lowerlevel, higherlevel, hist);  // O(logn*scale)
+        }
+        if(range.players == 0) {  // no players in lowerlevel, upperlevel
+            return PM_FAILURE;
+        }
+        for(int s = 1; s <= scale; ++s) {
+            counts[s-1] = hist[s];
+        }
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::getPercentOfPlayersWithScoreRangeInBounds(int GroupID, int lowerscore, int higherscore, int lowerlevel, int higherlevel, double* players) {
+    ArenaScope scope(arena);
+    if(!players || lowerscore > higherscore) {
+        return PM_INVALID_INPUT;
+    }
+    int counts[MAX_SCORE];
+    PMStatusType res = getScoreDistributionInBounds(GroupID, lowerlevel, higherlevel, counts);
+    if(res != PM_SUCCESS) {
+        return res;
+    }
+    int in_range = 0, total = 0;
+    for(int s = 1; s <= scale; ++s) {
+        total += counts[s-1];
+        if(s >= lowerscore && s <= higherscore) {
+            in_range += counts[s-1];
+        }
+    }
+    *players = 100 * double(in_range) / total;
+    return PM_SUCCESS;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::averageHighestPlayerLevelByGroup(int GroupID, int m, double* avgLevel) {
+    ArenaScope scope(arena);
     try {
         if(GroupID < 0 || GroupID > groups.Size() || !avgLevel || m <= 0) {
             return PM_INVALID_INPUT;
         }
         if(GroupID == 0) {
-            if(m > all_players_tree.getPlayersInTree()) {  // O(logn)
+            if(m > all_players_tree->getPlayersInTree()) {  // O(1)
                 return PM_FAILURE;
             }
-            *avgLevel = all_players_tree.averageHighestPlayerLevelByGroup(m);  // O(logn)
+            *avgLevel = all_players_tree->averageHighestPlayerLevelByGroup(m);  // O(logn)
         }
         else {
             int root = groups.Find(GroupID-1);
-            if(m > groups.groups[root].rt->getPlayersInTree()) {  // O(logn)
+            if(groups.groups[root].isEmpty() || m > groups.groups[root].getRankTree().getPlayersInTree()) {  // O(1)
                 return PM_FAILURE;
             }
-            *avgLevel = groups.groups[root].rt->averageHighestPlayerLevelByGroup(m);  // O(logn)
+            *avgLevel = groups.groups[root].getRankTree().averageHighestPlayerLevelByGroup(m);  // O(logn)
         }
     }
     catch(std::bad_alloc&) {
@@ -159,22 +316,133 @@ PMStatusType PlayersManager::averageHighestPlayerLevelByGroup(int GroupID, int m
     return PM_SUCCESS;
 }
 
-PMStatusType PlayersManager::getPlayersBound(int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers) {
-    if(!LowerBoundPlayers || !HigherBoundPlayers || GroupID > groups.Size() || GroupID < 0 || m < 0 || score <= 0 || score > scale) {
-        return PM_INVALID_INPUT;
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::selectLevel(int GroupID, int k, int* level) {
+    ArenaScope scope(arena);
+    try {
+        if(GroupID < 0 || GroupID > groups.Size() || !level || k <= 0) {
+            return PM_INVALID_INPUT;
+        }
+        if(GroupID == 0) {
+            if(k > all_players_tree->getPlayersInTree()) {  // O(1)
+                return PM_FAILURE;
+            }
+            *level = all_players_tree->selectLevel(k);  // O(logn)
+        }
+        else {
+            int root = groups.Find(GroupID-1);
+            if(groups.groups[root].isEmpty() || k > groups.groups[root].getRankTree().getPlayersInTree()) {  // O(1)
+                return PM_FAILURE;
+            }
+            *level = groups.groups[root].getRankTree().selectLevel(k);  // O(logn)
+        }
     }
-    if(GroupID == 0) {
-        if(m > all_players_tree.getPlayersInTree()) {  // O(logn)
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::levelPercentile(int GroupID, double p, int* level) {
+    ArenaScope scope(arena);
+    try {
+        if(GroupID < 0 || GroupID > groups.Size() || !level || p < 0 || p > 100) {
+            return PM_INVALID_INPUT;
+        }
+        int players = 0;
+        if(GroupID == 0) {
+            players = all_players_tree->getPlayersInTree();
+        }
+        else {
+            int root = groups.Find(GroupID-1);
+            if(!groups.groups[root].isEmpty()) {
+                players = groups.groups[root].getRankTree().getPlayersInTree();
+            }
+        }
+        if(players == 0) {
             return PM_FAILURE;
         }
-        all_players_tree.getPlayersBounds(score, m, LowerBoundPlayers, HigherBoundPlayers);
+        // nearest rank: the lowest level such that at least p percent of the players are at or below it
+        int rank_from_bottom = int(p * players / 100);
+        if(rank_from_bottom * 100.0 < p * players || rank_from_bottom == 0) {
+            rank_from_bottom++;
+        }
+        return selectLevel(GroupID, players - rank_from_bottom + 1, level);  // O(logn)
     }
-    else {
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::averageLevelInRankRange(int GroupID, int r1, int r2, double* avgLevel) {
+    ArenaScope scope(arena);
+    try {
+        if(GroupID < 0 || GroupID > groups.Size() || !avgLevel || r1 <= 0 || r2 < r1) {
+            return PM_INVALID_INPUT;
+        }
+        long long sum_r2, sum_r1;
+        if(GroupID == 0) {
+            if(r2 > all_players_tree->getPlayersInTree()) {  // O(1)
+                return PM_FAILURE;
+            }
+            sum_r2 = all_players_tree->sumHighestPlayerLevels(r2);  // O(logn)
+            sum_r1 = all_players_tree->sumHighestPlayerLevels(r1-1);  // O(logn)
+        }
+        else {
+            int root = groups.Find(GroupID-1);
+            if(groups.groups[root].isEmpty() || r2 > groups.groups[root].getRankTree().getPlayersInTree()) {  // O(1)
+                return PM_FAILURE;
+            }
+            sum_r2 = groups.groups[root].getRankTree().sumHighestPlayerLevels(r2);  // O(logn)
+            sum_r1 = groups.groups[root].getRankTree().sumHighestPlayerLevels(r1-1);  // O(logn)
+        }
+        *avgLevel = double(sum_r2 - sum_r1) / (r2 - r1 + 1);
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
+    }
+    return PM_SUCCESS;
+}
+
+template<class Tree, class AllTree>
+PMStatusType BasicPlayersManager<Tree, AllTree>::getPlayersBound(int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers) {
+    ArenaScope scope(arena);
+    if(!LowerBoundPlayers || !HigherBoundPlayers || GroupID > groups.Size() || GroupID < 0 || m < 0 || score <= 0 || score > scale) {
+        return PM_INVALID_INPUT;
+    }
+    try {
+        if(GroupID == 0) {
+            if(m > all_players_tree->getPlayersInTree()) {  // O(1)
+                return PM_FAILURE;
+            }
+            all_players_tree->getPlayersBounds(score, m, LowerBoundPlayers, HigherBoundPlayers);
+            return PM_SUCCESS;
+        }
         int root = groups.Find(GroupID-1);
-        if(m > groups.groups[root].rt->getPlayersInTree()) {  // O(logn)
+        if(groups.groups[root].isEmpty()) {
+            if(m > 0) {
+                return PM_FAILURE;
+            }
+            *LowerBoundPlayers = 0;
+            *HigherBoundPlayers = 0;
+            return PM_SUCCESS;
+        }
+        if(m > groups.groups[root].getRankTree().getPlayersInTree()) {  // O(1)
             return PM_FAILURE;
         }
-        groups.groups[root].rt->getPlayersBounds(score, m, LowerBoundPlayers, HigherBoundPlayers);
+        groups.groups[root].getRankTree().getPlayersBounds(score, m, LowerBoundPlayers, HigherBoundPlayers);
+    }
+    catch(std::bad_alloc&) {
+        return PM_ALLOCATION_ERROR;
     }
     return PM_SUCCESS;
-}
\ No newline at end of file
+}
+
+// the engines the C interface can be built with, see PlayersManager.h
+template class BasicPlayersManager<RankTree>;
+template class BasicPlayersManager<BasicRankTree<INLINE_SCORE_WIDTH>>;
+template class BasicPlayersManager<BPlusRankTree>;
+template class BasicPlayersManager<ScoreIndexRankTree>;
+template class BasicPlayersManager<DefaultRankTree, FenwickRankTree>;
@@ -3,7 +3,13 @@
 
 #include "UF.h"
 #include "RankTree.h"
+#include "BPlusRankTree.h"
+#include "ScoreIndexRankTree.h"
+#include "FenwickRankTree.h"
 #include "DynamicHashTable.h"
+#include "HandleTable.h"
+#include "Arena.h"
+#include <climits>
 
 typedef enum {
     PM_SUCCESS = 0,
@@ -12,26 +18,119 @@ typedef enum {
     PM_INVALID_INPUT = -3
 } PMStatusType;
 
+typedef HandleTable<Player> PlayerHandles;
+
+// the interface the C functions call, so Init can pick the engine at runtime.
+// a manager made by create lives in its own Arena with everything it allocates, and destroy frees all of it at once
+// instead of releasing the nodes one by one. the managers set their arena as the current one in every function.
 class PlayersManager {
+    protected:
+        Arena* arena;  // nullptr if the manager was made with new
+
+    public:
+        PlayersManager() : arena(nullptr) { }
+        virtual ~PlayersManager() = default;
+
+        template<class Manager, class... Args>
+        static Manager* create(Args&&... args) {
+            Arena* arena = new Arena();
+            try {
+                ArenaScope scope(arena);
+                Manager* manager = Arena::create<Manager>(std::forward<Args>(args)...);
+                static_cast<PlayersManager*>(manager)->arena = arena;
+                return manager;
+            }
+            catch(...) {
+                delete arena;
+                throw;
+            }
+        }
+
+        // O(#chunks) for a manager made by create, its destructor isn't run
+        static void destroy(PlayersManager* manager) {
+            if(!manager) {
+                return;
+            }
+            if(manager->arena) {
+                delete manager->arena;
+                return;
+            }
+            delete manager;
+        }
+
+        virtual PMStatusType mergeGroups(int GroupID1, int GroupID2) = 0;
+        // if handle isn't null it is set to the new player's handle, which the ByHandle functions take instead of its
+        // id. once the player is removed they return PM_FAILURE for the handle
+        virtual PMStatusType addPlayer(int PlayerID, int GroupID, int score, PlayerHandles::Handle* handle) = 0;
+        virtual PMStatusType removePlayer(int PlayerID) = 0;
+        virtual PMStatusType removePlayerByHandle(PlayerHandles::Handle handle) = 0;
+        virtual PMStatusType increasePlayerIDLevel(int PlayerID, int LevelIncrease) = 0;
+        virtual PMStatusType increasePlayerLevelByHandle(PlayerHandles::Handle handle, int LevelIncrease) = 0;
+        virtual PMStatusType changePlayerIDScore(int PlayerID, int NewScore) = 0;
+        virtual PMStatusType changePlayerScoreByHandle(PlayerHandles::Handle handle, int NewScore) = 0;
+        virtual PMStatusType getPercentOfPlayersWithScoreInBounds(int GroupID, int score, int lowerlevel, int higherlevel, double* players) = 0;
+        virtual PMStatusType getScoreDistributionInBounds(int GroupID, int lowerlevel, int higherlevel, int* counts) = 0;
+        virtual PMStatusType getPercentOfPlayersWithScoreRangeInBounds(int GroupID, int lowerscore, int higherscore, int lowerlevel, int higherlevel, double* players) = 0;
+        virtual PMStatusType averageHighestPlayerLevelByGroup(int GroupID, int m, double* avgLevel) = 0;
+        virtual PMStatusType selectLevel(int GroupID, int k, int* level) = 0;
+        virtual PMStatusType levelPercentile(int GroupID, double p, int* level) = 0;
+        virtual PMStatusType averageLevelInRankRange(int GroupID, int r1, int r2, double* avgLevel) = 0;
+        virtual PMStatusType getPlayersBound(int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers) = 0;
+};
+
+// Tree is the engine that keeps the levels of a group: RankTree (an AVL tree), BPlusRankTree or ScoreIndexRankTree.
+// AllTree keeps the levels of all the players, the same engine by default or FenwickRankTree for a bounded level
+// domain (see BoundedPlayersManager). the combinations in use are instantiated in PlayersManager.cpp.
+// levels are capped at max_level, FenwickRankTree needs a real bound and the other engines get NO_MAX_LEVEL.
+template<class Tree, class AllTree = Tree>
+class BasicPlayersManager : public PlayersManager {
     private:
-        UF groups;
-        RankTree all_players_tree;
+        UF<Tree> groups;
+        std::shared_ptr<AllTree> all_players_tree;
         DHT all_players;
+        PlayerHandles handles;
         int scale;
+        int max_level;
+
+        void removeFromTrees(std::shared_ptr<Player>& player);
+        void increaseLevel(std::shared_ptr<Player>& player, int LevelIncrease);
+        void changeScore(std::shared_ptr<Player>& player, int NewScore);
 
     public:
-        PlayersManager(int k, int scale);
-        PMStatusType mergeGroups(int GroupID1, int GroupID2);
-        PMStatusType addPlayer(int PlayerID, int GroupID, int score);
-        PMStatusType removePlayer(int PlayerID);
-        PMStatusType increasePlayerIDLevel(int PlayerID, int LevelIncrease);
-        PMStatusType changePlayerIDScore(int PlayerID, int NewScore);
-        PMStatusType getPercentOfPlayersWithScoreInBounds(int GroupID, int score, int lowerlevel, int higherlevel, double* players);
-        PMStatusType averageHighestPlayerLevelByGroup(int GroupID, int m, double* avgLevel);
-        PMStatusType getPlayersBound(int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers);
-        // ~PlayersManager();
-        
+        static const int NO_MAX_LEVEL = INT_MAX;
 
+        BasicPlayersManager(int k, int scale, int max_level = NO_MAX_LEVEL);
+        PMStatusType mergeGroups(int GroupID1, int GroupID2) override;
+        PMStatusType addPlayer(int PlayerID, int GroupID, int score, PlayerHandles::Handle* handle) override;
+        PMStatusType removePlayer(int PlayerID) override;
+        PMStatusType removePlayerByHandle(PlayerHandles::Handle handle) override;
+        PMStatusType increasePlayerIDLevel(int PlayerID, int LevelIncrease) override;
+        PMStatusType increasePlayerLevelByHandle(PlayerHandles::Handle handle, int LevelIncrease) override;
+        PMStatusType changePlayerIDScore(int PlayerID, int NewScore) override;
+        PMStatusType changePlayerScoreByHandle(PlayerHandles::Handle handle, int NewScore) override;
+        PMStatusType getPercentOfPlayersWithScoreInBounds(int GroupID, int score, int lowerlevel, int higherlevel, double* players) override;
+        PMStatusType getScoreDistributionInBounds(int GroupID, int lowerlevel, int higherlevel, int* counts) override;
+        PMStatusType getPercentOfPlayersWithScoreRangeInBounds(int GroupID, int lowerscore, int higherscore, int lowerlevel, int higherlevel, double* players) override;
+        PMStatusType averageHighestPlayerLevelByGroup(int GroupID, int m, double* avgLevel) override;
+        PMStatusType selectLevel(int GroupID, int k, int* level) override;
+        PMStatusType levelPercentile(int GroupID, double p, int* level) override;
+        PMStatusType averageLevelInRankRange(int GroupID, int r1, int r2, double* avgLevel) override;
+        PMStatusType getPlayersBound(int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers) override;
 };
 
+// the engine used by Init, build with -DWET2_BPLUS_RANKTREE to use the B+tree
+// or with -DWET2_SCORE_INDEX_RANKTREE to use the per score indexes.
+#if defined(WET2_BPLUS_RANKTREE)
+typedef BPlusRankTree DefaultRankTree;
+#elif defined(WET2_SCORE_INDEX_RANKTREE)
+typedef ScoreIndexRankTree DefaultRankTree;
+#else
+typedef RankTree DefaultRankTree;
+#endif
+typedef BasicPlayersManager<DefaultRankTree> DefaultPlayersManager;
+
+// the manager of InitWithMaxLevel. only the tree of all the players is a dense FenwickRankTree, the groups keep the
+// default engine, so their memory grows with their levels and their merges don't cost O(max_level*scale)
+typedef BasicPlayersManager<DefaultRankTree, FenwickRankTree> BoundedPlayersManager;
+
 #endif
\ No newline at end of file
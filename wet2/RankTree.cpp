@@ -1,100 +1,102 @@
 #include "RankTree.h"
 #include "Array.h"
+#include "Histogram.h"
+#include "Parallel.h"
+
+// merges of fewer levels than this run on a single thread, starting threads would cost more than they save.
+// build with -DWET2_PARALLEL_MERGE_MIN_LEVELS=<n> to change it
+#ifndef WET2_PARALLEL_MERGE_MIN_LEVELS
+#define WET2_PARALLEL_MERGE_MIN_LEVELS 65536
+#endif
 
 /********************************** HELPER FUNCTIONS **********************************/
 
-int RankTree::max(const int a, const int b) {
+template<int Width>
+int BasicRankTree<Width>::max(const int a, const int b) {
     return (a > b) ? a : b;
 }
 
-int RankTree::min(const int a, const int b) {
+template<int Width>
+int BasicRankTree<Width>::min(const int a, const int b) {
     return (a < b) ? a : b;
 }
 
-int RankTree::height(const std::shared_ptr<TreeNode>& root) {
+template<int Width>
+int BasicRankTree<Width>::height(const std::shared_ptr<Node>& root) {
     if(!root) {
         return -1;
     }
     return root->height;
 }
 
-int RankTree::get_balance_factor(const std::shared_ptr<TreeNode>& root) {
+template<int Width>
+int BasicRankTree<Width>::get_balance_factor(const std::shared_ptr<Node>& root) {
     return height(root->left) - height(root->right);
 }
 
-void RankTree::decrease_counts(const std::shared_ptr<TreeNode>& A, const std::shared_ptr<TreeNode>& B) {
+template<int Width>
+void BasicRankTree<Width>::decrease_counts(const std::shared_ptr<Node>& A, const std::shared_ptr<Node>& B) {
     // A-B
     if(!A || !B) {
         return;
     }
-    for (int i = 0; i < A->scale; ++i) {
-        A->scores_hist[i] = max(0, A->scores_hist[i] - B->scores_hist[i]);
-    }
+    A->scores_hist.subtract(B->scores_hist, A->scale);
 }
 
-void RankTree::increase_counts(const std::shared_ptr<TreeNode>& A, const std::shared_ptr<TreeNode>& B) {
+template<int Width>
+void BasicRankTree<Width>::increase_counts(const std::shared_ptr<Node>& A, const std::shared_ptr<Node>& B) {
     // A+B
     if(!A || !B) {
         return;
     }
-    for (int i = 0; i < A->scale; ++i) {
-        A->scores_hist[i] += B->scores_hist[i];
-    }
+    A->scores_hist.add(B->scores_hist, A->scale);
 }
 
-void RankTree::decrease_counts(int* A, int* B, int scale) {
-    if(!A || !B) {
-        return;
-    }
-    for (int i = 0; i < scale; ++i) {
-        A[i] = max(0, A[i]-B[i]);
-    }
+template<int Width>
+void BasicRankTree<Width>::decrease_counts(Hist& A, const Hist& B, int scale) {
+    A.subtract(B, scale);
 }
-void RankTree::increase_counts(int* A, int* B, int scale) {
-    if(!A || !B) {
-        return;
-    }
-    for (int i = 0; i < scale; ++i) {
-        A[i] += B[i];
-    }
+template<int Width>
+void BasicRankTree<Width>::increase_counts(Hist& A, const Hist& B, int scale) {
+    A.add(B, scale);
 }
 
-double RankTree::sumOfLevelsInSubtree(std::shared_ptr<TreeNode>& root) {
-    if(!root) {
-        return 0;
-    }
-    return root->average_level_in_subtree * root->players_in_subtree;
+template<int Width>
+void BasicRankTree<Width>::recalculate_histogram(std::shared_ptr<Node>& root) {
+    // scores_hist = self_scores_hist + left->scores_hist + right->scores_hist in a single pass
+    root->scores_hist.sum(root->self_scores_hist,
+                          root->left ? &root->left->scores_hist : nullptr,
+                          root->right ? &root->right->scores_hist : nullptr, root->scale);
 }
-int RankTree::getPlayersInSubtree(std::shared_ptr<TreeNode>& root) {
+
+template<int Width>
+long long BasicRankTree<Width>::sumOfLevelsInSubtree(const std::shared_ptr<Node>& root) {
     if(!root) {
         return 0;
     }
-    return root->players_in_subtree;
+    return root->sum_levels_in_subtree;
 }
-
-double RankTree::getAverageLevelInSubtree(std::shared_ptr<TreeNode>& root) {
+template<int Width>
+int BasicRankTree<Width>::getPlayersInSubtree(const std::shared_ptr<Node>& root) {
     if(!root) {
         return 0;
     }
-    return root->average_level_in_subtree;
+    return root->players_in_subtree;
 }
 
-void RankTree::recalculate_average(std::shared_ptr<TreeNode>& root) {
+template<int Width>
+void BasicRankTree<Width>::recalculate_sums(std::shared_ptr<Node>& root) {
     if(!root) {
         return;
     }
     root->players_in_subtree = root->players_in_level + getPlayersInSubtree(root->left) + getPlayersInSubtree(root->right);
-    if(root->players_in_subtree == 0) {
-        root->average_level_in_subtree = 0;
-        return;
-    }
-    root->average_level_in_subtree = (sumOfLevelsInSubtree(root->left) +
-                                     (sumOfLevelsInSubtree(root->right)) +
-                                     (root->level_id * root->players_in_level)) / root->players_in_subtree;
+    root->sum_levels_in_subtree = sumOfLevelsInSubtree(root->left) + sumOfLevelsInSubtree(root->right) +
+                                  (long long)root->level_id * root->players_in_level;
 }
 
-void RankTree::RR_rotation(std::shared_ptr<TreeNode>& parent) {
-    std::shared_ptr<TreeNode> child = parent->right;
+template<int Width>
+void BasicRankTree<Width>::RR_rotation(std::shared_ptr<Node>& parent) {
+    std::shared_ptr<Node> child = parent->right;
     decrease_counts(parent, child);  // A-B
     decrease_counts(child, child->left);  // B-B->left
     parent->right = child->left;
@@ -103,21 +105,23 @@ void RankTree::RR_rotation(std::shared_ptr<TreeNode>& parent) {
     child->left = parent;
     parent = child; //parent = B, parent->left = A
     
-    std::shared_ptr<TreeNode>& A = parent->left;
-    std::shared_ptr<TreeNode>& B = parent;
+    std::shared_ptr<Node>& A = parent->left;
+    std::shared_ptr<Node>& B = parent;
     increase_counts(A, A->right);  // A+A->right
     increase_counts(B, A);  // B+A
-    recalculate_average(A);
-    recalculate_average(B);    
+    recalculate_sums(A);
+    recalculate_sums(B);    
 }
-void RankTree::RL_rotation(std::shared_ptr<TreeNode>& parent) {
+template<int Width>
+void BasicRankTree<Width>::RL_rotation(std::shared_ptr<Node>& parent) {
     LL_rotation(parent->right);
     RR_rotation(parent);
 }
-void RankTree::LL_rotation(std::shared_ptr<TreeNode>& parent)
+template<int Width>
+void BasicRankTree<Width>::LL_rotation(std::shared_ptr<Node>& parent)
 {
-    std::shared_ptr<TreeNode> child = parent->left;
-    std::shared_ptr<TreeNode> tmp = child->right;
+    std::shared_ptr<Node> child = parent->left;
+    std::shared_ptr<Node> tmp = child->right;
     decrease_counts(parent, child); // B-A
     decrease_counts(child, child->right); // A-A->right
     child->right = parent;
@@ -125,19 +129,21 @@ void RankTree::LL_rotation(std::shared_ptr<TreeNode>& parent)
     parent->height = 1 + max(height(parent->left), height(parent->right));
     child->height = 1 + max(height(child->left), height(child->right));
     parent = child;
-    std::shared_ptr<TreeNode>& B = parent->right;
-    std::shared_ptr<TreeNode>& A = parent;
+    std::shared_ptr<Node>& B = parent->right;
+    std::shared_ptr<Node>& A = parent;
     increase_counts(B, B->left);  // B+B->left
     increase_counts(A, B);  // B+A
-    recalculate_average(B);
-    recalculate_average(A);
+    recalculate_sums(B);
+    recalculate_sums(A);
 }
-void RankTree::LR_rotation(std::shared_ptr<TreeNode>& parent) {
+template<int Width>
+void BasicRankTree<Width>::LR_rotation(std::shared_ptr<Node>& parent) {
     RR_rotation(parent->left);
     LL_rotation(parent);
 }
 
-void RankTree::balance_aux(std::shared_ptr<TreeNode>& root) {
+template<int Width>
+void BasicRankTree<Width>::balance_aux(std::shared_ptr<Node>& root) {
     if(!root) {
         return;
     }
@@ -161,7 +167,8 @@ void RankTree::balance_aux(std::shared_ptr<TreeNode>& root) {
     }
 }
 
-const std::shared_ptr<TreeNode>& RankTree::find_level_aux(const std::shared_ptr<TreeNode>& root, const int level_id) {
+template<int Width>
+const std::shared_ptr<BasicTreeNode<Width>>& BasicRankTree<Width>::find_level_aux(const std::shared_ptr<Node>& root, const int level_id) {
     if(!root || level_id == root->level_id) {
         return root;
     }
@@ -173,9 +180,10 @@ const std::shared_ptr<TreeNode>& RankTree::find_level_aux(const std::shared_ptr<
     }
 }
 
-void RankTree::insert_level_aux(std::shared_ptr<TreeNode>& root, const int level_id, const std::shared_ptr<Player>& player, int scale) {
+template<int Width>
+void BasicRankTree<Width>::insert_level_aux(std::shared_ptr<Node>& root, const int level_id, const std::shared_ptr<Player>& player, int scale) {
     if(!root) {
-        root = std::make_shared<TreeNode>(scale, level_id);
+        root = Arena::makeShared<Node>(scale, level_id);
         insert_player_aux(root, player->level, player);
         return;
     }
@@ -185,14 +193,15 @@ void RankTree::insert_level_aux(std::shared_ptr<TreeNode>& root, const int level
     else  {
         insert_level_aux(root->right, level_id, player, scale);
     }
-    root->average_level_in_subtree = (root->average_level_in_subtree*root->players_in_subtree + player->level)/(root->players_in_subtree+1);
+    root->sum_levels_in_subtree += player->level;
     root->players_in_subtree++;
-    root->scores_hist[player->score]++;
+    root->scores_hist.increase(player->score, 1, root->scale);
     balance_aux(root);
     root->height = 1 + max(height(root->left), height(root->right));
 }
 
-void RankTree::change_player_score_aux(std::shared_ptr<TreeNode>& root, const int level, const int old_score, const int new_score) {
+template<int Width>
+void BasicRankTree<Width>::change_player_score_aux(std::shared_ptr<Node>& root, const int level, const int old_score, const int new_score) {
     if(!root) {
         return;
     }
@@ -203,20 +212,72 @@ void RankTree::change_player_score_aux(std::shared_ptr<TreeNode>& root, const in
         change_player_score_aux(root->left, level, old_score, new_score);
     }
     else {
-        root->self_scores_hist[old_score]--;
-        root->self_scores_hist[new_score]++;
+        root->self_scores_hist.increase(old_score, -1, root->scale);
+        root->self_scores_hist.increase(new_score, 1, root->scale);
+    }
+    root->scores_hist.increase(old_score, -1, root->scale);
+    root->scores_hist.increase(new_score, 1, root->scale);
+}
+
+// count players with the score join (count > 0) or leave (count < 0) an existing level, O(logn)
+template<int Width>
+void BasicRankTree<Width>::add_to_level_aux(std::shared_ptr<Node>& root, const int level, const int score, const int count) {
+    root->players_in_subtree += count;
+    root->sum_levels_in_subtree += (long long)level * count;
+    root->scores_hist.increase(score, count, root->scale);
+    if(level == root->level_id) {
+        root->players_in_level += count;
+        root->self_scores_hist.increase(score, count, root->scale);
+    }
+    else if(level < root->level_id) {
+        add_to_level_aux(root->left, level, score, count);
+    }
+    else {
+        add_to_level_aux(root->right, level, score, count);
+    }
+}
+
+/**
+ * move_player_aux: moves a player between two existing levels in a single descent. above the lowest common ancestor
+ * of the levels the subtree keeps the same players and scores, so only the level sums change there, and the counts
+ * and histograms are only updated on the two paths below it. O(logn)
+*/
+template<int Width>
+void BasicRankTree<Width>::move_player_aux(std::shared_ptr<Node>& root, const int old_level, const int new_level, const int score) {
+    root->sum_levels_in_subtree += (long long)new_level - old_level;
+    if(old_level < root->level_id && new_level < root->level_id) {
+        move_player_aux(root->left, old_level, new_level, score);
+        return;
+    }
+    if(old_level > root->level_id && new_level > root->level_id) {
+        move_player_aux(root->right, old_level, new_level, score);
+        return;
+    }
+    // root is the lowest common ancestor, its players_in_subtree and scores_hist don't change
+    if(old_level == root->level_id) {
+        root->players_in_level--;
+        root->self_scores_hist.increase(score, -1, root->scale);
+    }
+    else {
+        add_to_level_aux((old_level < root->level_id) ? root->left : root->right, old_level, score, -1);
+    }
+    if(new_level == root->level_id) {
+        root->players_in_level++;
+        root->self_scores_hist.increase(score, 1, root->scale);
+    }
+    else {
+        add_to_level_aux((new_level < root->level_id) ? root->left : root->right, new_level, score, 1);
     }
-    root->scores_hist[old_score]--;
-    root->scores_hist[new_score]++;
 }
 
-void RankTree::insert_player_aux(std::shared_ptr<TreeNode>& root, const int level_id, const std::shared_ptr<Player>& player) {
-    root->average_level_in_subtree = (root->average_level_in_subtree*root->players_in_subtree + player->level)/(root->players_in_subtree+1);
+template<int Width>
+void BasicRankTree<Width>::insert_player_aux(std::shared_ptr<Node>& root, const int level_id, const std::shared_ptr<Player>& player) {
+    root->sum_levels_in_subtree += player->level;
     root->players_in_subtree++;
-    root->scores_hist[player->score]++;
+    root->scores_hist.increase(player->score, 1, root->scale);
     if(level_id == root->level_id) {
         root->players_in_level++;
-        root->self_scores_hist[player->score]++;
+        root->self_scores_hist.increase(player->score, 1, root->scale);
         return;
     }
     else if(level_id < root->level_id) {
@@ -229,7 +290,8 @@ void RankTree::insert_player_aux(std::shared_ptr<TreeNode>& root, const int leve
     }
 }
 
-void RankTree::remove_player_aux(std::shared_ptr<TreeNode>& root, std::shared_ptr<Player>& player) {
+template<int Width>
+void BasicRankTree<Width>::remove_player_aux(std::shared_ptr<Node>& root, std::shared_ptr<Player>& player) {
     if(!root) {
         return;
     }
@@ -243,21 +305,17 @@ void RankTree::remove_player_aux(std::shared_ptr<TreeNode>& root, std::shared_pt
     }
     else {  // key == root->key
         root->players_in_level--;
-        root->self_scores_hist[player->score]--;
+        root->self_scores_hist.increase(player->score, -1, root->scale);
     }
     // assuming player is always found
-    if(root->players_in_subtree - 1 == 0) {
-        root->average_level_in_subtree = 0;
-    }
-    else {
-        root->average_level_in_subtree = (root->average_level_in_subtree*root->players_in_subtree - player->level)/(root->players_in_subtree-1);
-    }
+    root->sum_levels_in_subtree -= player->level;
     root->players_in_subtree--;
-    root->scores_hist[player->score]--;
+    root->scores_hist.increase(player->score, -1, root->scale);
     
 }
 
-void RankTree::remove_level_aux(std::shared_ptr<TreeNode>& root, const int level_id) {
+template<int Width>
+void BasicRankTree<Width>::remove_level_aux(std::shared_ptr<Node>& root, const int level_id) {
     if(!root) {
         return;
     }
@@ -284,25 +342,22 @@ void RankTree::remove_level_aux(std::shared_ptr<TreeNode>& root, const int level
         }
         // root has both childs
         else {
-            std::shared_ptr<TreeNode> next = root->right;
+            std::shared_ptr<Node> next = root->right;
             while(next->left) {
                 next = next->left;
             }
             root->swap_data(*next.get());
 
             remove_level_and_fix_hist_aux(root->right, next->level_id, root->self_scores_hist);
-            recalculate_average(root);
-
-            resetHistogram(root->scores_hist, root->scale);
-            increase_counts(root->scores_hist, root->self_scores_hist, root->scale);
-            increase_counts(root, root->left);
-            increase_counts(root, root->right);
+            recalculate_sums(root);
+            recalculate_histogram(root);
         }
     }
     balance_aux(root);
 }
 
-void RankTree::remove_level_and_fix_hist_aux(std::shared_ptr<TreeNode>& root, const int level_id, int* hist) {
+template<int Width>
+void BasicRankTree<Width>::remove_level_and_fix_hist_aux(std::shared_ptr<Node>& root, const int level_id, const Hist& hist) {
     if(!root) {
         return;
     }
@@ -319,30 +374,13 @@ void RankTree::remove_level_and_fix_hist_aux(std::shared_ptr<TreeNode>& root, co
         root = root->right;
         return;
     }
-    recalculate_average(root);
+    recalculate_sums(root);
     decrease_counts(root->scores_hist, hist, root->scale);
 }
 
-void RankTree::update_zero_path(std::shared_ptr<TreeNode>& root) {
-    if(root->level_id == 0){
-        return;
-    }
-    decrease_counts(root, root->left);
-    update_zero_path(root->left);
-    if(root->left->level_id == 0){
-        resetHistogram(root->scores_hist, root->scale);
-        increase_counts(root->scores_hist, root->self_scores_hist, root->scale);
-        increase_counts(root, root->right);
-        increase_counts(root, root->left);
-    }
-    else {
-        increase_counts(root, root->left);
-    }
-    recalculate_average(root);
-}
-
 /********************************** MERGE FUNCTIONS **********************************/
-void RankTree::inorderToList(const std::shared_ptr<TreeNode>& root, Array<std::shared_ptr<TreeNode>>& list) {
+template<int Width>
+void BasicRankTree<Width>::inorderToList(const std::shared_ptr<Node>& root, Array<std::shared_ptr<Node>>& list) {
     if(!root) {
         return;
     }
@@ -350,235 +388,472 @@ void RankTree::inorderToList(const std::shared_ptr<TreeNode>& root, Array<std::s
     list.push_back(root);
     inorderToList(root->right, list);
 }
-Array<std::shared_ptr<TreeNode>> RankTree::getTreeAsList() const {
-    Array<std::shared_ptr<TreeNode>> list(number_of_levels);
+template<int Width>
+Array<std::shared_ptr<BasicTreeNode<Width>>> BasicRankTree<Width>::getTreeAsList() const {
+    Array<std::shared_ptr<Node>> list(number_of_levels);
     inorderToList(root, list);  // O(n)
     return list; 
 }
+template<int Width>
 class NodesComparator {
     public:
-        bool operator()(std::shared_ptr<TreeNode> left, std::shared_ptr<TreeNode> right) {
+        bool operator()(const std::shared_ptr<BasicTreeNode<Width>>& left, const std::shared_ptr<BasicTreeNode<Width>>& right) {
             return left->level_id < right->level_id;
         }
 };
 
-std::shared_ptr<TreeNode> RankTree::getTreeFromListAux(const Array<std::shared_ptr<TreeNode>>& list, int start, int end) {
+// the number of threads a linear merge of levels levels may use
+template<int Width>
+int BasicRankTree<Width>::mergeThreads(int levels) {
+    if(levels < WET2_PARALLEL_MERGE_MIN_LEVELS) {
+        return 1;
+    }
+    return Parallel::threads();
+}
+
+/**
+ * getTreeFromListAux: links list[start..end] into a balanced tree, moving the nodes out of the list. while
+ * threads > 1 the left half is built on another thread, the two halves share no nodes.
+*/
+template<int Width>
+std::shared_ptr<BasicTreeNode<Width>> BasicRankTree<Width>::getTreeFromListAux(Array<std::shared_ptr<Node>>& list, int start, int end, int threads) {
     if(start > end) {
         return nullptr;
     }
     int mid = (start+end)/2;
-    std::shared_ptr<TreeNode> root = list[mid];
-    root->left = getTreeFromListAux(list, start, mid-1);
-    root->right = getTreeFromListAux(list, mid+1, end);
+    std::shared_ptr<Node> root = std::move(list[mid]);
+    bool parallel = threads > 1;
+    Parallel::invoke(parallel,
+        [&]() { root->left = getTreeFromListAux(list, start, mid-1, parallel ? threads/2 : 1); },
+        [&]() { root->right = getTreeFromListAux(list, mid+1, end, parallel ? threads - threads/2 : 1); });
     return root;
 }
 
-RankTree* RankTree::getTreeFromList(const Array<std::shared_ptr<TreeNode>>& list, int scale) {
-    RankTree* rt = new RankTree(scale);
-    rt->root = getTreeFromListAux(list, 0, list.getSize());
+template<int Width>
+BasicRankTree<Width>* BasicRankTree<Width>::getTreeFromList(Array<std::shared_ptr<Node>>&& list, int scale) {
+    BasicRankTree* rt = Arena::create<BasicRankTree>(scale);
+    rt->root = getTreeFromListAux(list, 0, list.getSize(), mergeThreads(list.getSize()+1));
     rt->number_of_levels = list.getSize()+1;
-    rt->level_zero = rt->findLevel(0);
     return rt;
 }
 
-Array<std::shared_ptr<TreeNode>> RankTree::mergeToList(const RankTree& rt1, const RankTree& rt2) {
-    NodesComparator cmp;
-    Array<std::shared_ptr<TreeNode>> list1 = rt1.getTreeAsList();  // O(n)
-    Array<std::shared_ptr<TreeNode>> list2 = rt2.getTreeAsList();  // O(m)
-    Array<std::shared_ptr<TreeNode>> merged_list = Array<std::shared_ptr<TreeNode>>::merge(list1, list2, cmp);  // O(n+m)
-    Array<std::shared_ptr<TreeNode>> merged_list_no_duplicates = removeDuplicates(merged_list);
-    return merged_list_no_duplicates;
+template<int Width>
+Array<std::shared_ptr<BasicTreeNode<Width>>> BasicRankTree<Width>::mergeToList(const BasicRankTree& rt1, const BasicRankTree& rt2) {
+    Array<std::shared_ptr<Node>> list1, list2;
+    Parallel::invoke(mergeThreads(rt1.number_of_levels + rt2.number_of_levels) > 1,
+        [&]() { list1 = rt1.getTreeAsList(); },  // O(n)
+        [&]() { list2 = rt2.getTreeAsList(); });  // O(m)
+    NodesComparator<Width> cmp;
+    // O((n+m)/threads), Array::merge runs on several threads for large lists
+    return removeDuplicates(Array<std::shared_ptr<Node>>::merge(std::move(list1), std::move(list2), cmp));
 }
 
-Array<std::shared_ptr<TreeNode>> RankTree::removeDuplicates(const Array<std::shared_ptr<TreeNode>>& list) {
-    int real_size = 1;
-    int size = list.getSize();
-    for(int i = 0; i < size; ++i) {  // O(m+n)
-        real_size += list[i]->level_id != list[i+1]->level_id;
+/**
+ * mergeToListAux: merges the level lists of trees[start..end] pairwise, so a level is compared O(log(#trees)) times.
+ * duplicates are removed after every pairwise merge, so each merged list holds every level at most twice.
+ * the two halves are merged by different threads while threads > 1.
+*/
+template<int Width>
+Array<std::shared_ptr<BasicTreeNode<Width>>> BasicRankTree<Width>::mergeToListAux(const Array<std::shared_ptr<BasicRankTree>>& trees, int start, int end, int threads) {
+    if(start == end) {
+        return trees[start]->getTreeAsList();
     }
-    Array<std::shared_ptr<TreeNode>> new_list(real_size);
-    for(int i=0; i <= size; ++i) {  // O(m+n)
-        if((i < size && (list[i]->level_id != list[i+1]->level_id)) || (i == size && (list[i-1]->level_id != list[i]->level_id))) {
-            new_list.push_back(list[i]);
-        }
-        else {
-            list[i]->players_in_level += list[i+1]->players_in_level;
-            increase_counts(list[i], list[i+1]);
-            increase_counts(list[i]->self_scores_hist, list[i+1]->self_scores_hist, list[i]->scale);
-            new_list.push_back(list[i]);
-            i++;
+    int mid = (start+end)/2;
+    Array<std::shared_ptr<Node>> list1, list2;
+    Parallel::invoke(threads > 1,
+        [&]() { list1 = mergeToListAux(trees, start, mid, threads/2); },
+        [&]() { list2 = mergeToListAux(trees, mid+1, end, threads - threads/2); });
+    NodesComparator<Width> cmp;
+    return removeDuplicates(Array<std::shared_ptr<Node>>::merge(std::move(list1), std::move(list2), cmp));
+}
+
+/**
+ * removeDuplicates: combines the two nodes of every level that appears twice. the list is cut into one part per
+ * thread without separating the two nodes of a level; every part counts its levels, and after a prefix sum of the
+ * counts every part combines its duplicates and writes its levels into its place in the new list.
+*/
+template<int Width>
+Array<std::shared_ptr<BasicTreeNode<Width>>> BasicRankTree<Width>::removeDuplicates(Array<std::shared_ptr<Node>>&& list) {
+    int size = list.getSize()+1;
+    std::shared_ptr<Node>* in = list.getData();
+    int threads = mergeThreads(size);
+    Array<int> bounds(threads+1), counts(threads+1);
+    for(int chunk = 0; chunk <= threads; ++chunk) {
+        int bound = (long long)size * chunk / threads;
+        if(bound > 0 && bound < size && in[bound-1]->level_id == in[bound]->level_id) {
+            bound++;  // keep both nodes of the level in the same part
         }
+        bounds.push_back(bound);
     }
+    counts.setPopulated(threads+1);
+    Parallel::forEachChunk(threads, [&](int chunk) {
+        int count = 0;
+        for(int i = bounds[chunk]; i < bounds[chunk+1]; ++i) {  // O((m+n)/threads)
+            count += (i == bounds[chunk+1]-1 || in[i]->level_id != in[i+1]->level_id);
+        }
+        counts[chunk+1] = count;
+    });
+    counts[0] = 0;
+    for(int chunk = 0; chunk < threads; ++chunk) {
+        counts[chunk+1] += counts[chunk];
+    }
+    Array<std::shared_ptr<Node>> new_list(counts[threads]);
+    std::shared_ptr<Node>* out = new_list.getData();
+    Parallel::forEachChunk(threads, [&](int chunk) {
+        int next = counts[chunk];
+        for(int i = bounds[chunk]; i < bounds[chunk+1]; ++i) {  // O((m+n)/threads)
+            if(i < bounds[chunk+1]-1 && in[i]->level_id == in[i+1]->level_id) {  // never looks into the next part
+                in[i]->players_in_level += in[i+1]->players_in_level;
+                increase_counts(in[i], in[i+1]);
+                increase_counts(in[i]->self_scores_hist, in[i+1]->self_scores_hist, in[i]->scale);
+                out[next++] = std::move(in[i++]);
+            }
+            else {
+                out[next++] = std::move(in[i]);
+            }
+        }
+    });
+    new_list.setPopulated(counts[threads]);
     return new_list;
 }
 
-void RankTree::resetHistogram(int* histogram, int scale) {  // O(1)
-    for (int i = 0; i < scale; i++) {
-        histogram[i] = 0;
-    }
-}
-
-void RankTree::updateMergedTree(std::shared_ptr<TreeNode>& root) {
+/**
+ * updateMergedTree: recalculates the histograms, sums and heights of a tree built from a list, bottom up.
+ * the two subtrees are disjoint, so while threads > 1 the left one is filled by another thread.
+*/
+template<int Width>
+void BasicRankTree<Width>::updateMergedTree(std::shared_ptr<Node>& root, int threads) {
     if(!root) {
         return;
     }
-    updateMergedTree(root->left);
-    updateMergedTree(root->right);
-    resetHistogram(root->scores_hist, root->scale);
-    increase_counts(root->scores_hist, root->self_scores_hist, root->scale);
-    increase_counts(root, root->left);
-    increase_counts(root, root->right);
-    recalculate_average(root);
+    bool parallel = threads > 1;
+    Parallel::invoke(parallel,
+        [&]() { updateMergedTree(root->left, parallel ? threads/2 : 1); },
+        [&]() { updateMergedTree(root->right, parallel ? threads - threads/2 : 1); });
+    recalculate_histogram(root);
+    recalculate_sums(root);
+    root->height = 1 + max(height(root->left), height(root->right));
 }
 
-RankTree* RankTree::listToRankTree(const Array<std::shared_ptr<TreeNode>>& list, int scale) {
-    RankTree* rt = getTreeFromList(list, scale);  // O(n+m)
+template<int Width>
+BasicRankTree<Width>* BasicRankTree<Width>::listToRankTree(Array<std::shared_ptr<Node>>&& list, int scale) {
+    BasicRankTree* rt = getTreeFromList(std::move(list), scale);  // O(n+m)
     return rt;
     // counting copying and destructing lists and trees (if performed), the overall complexity is still O(n+m)
 }
-RankTree* RankTree::merge(const RankTree& rt1, const RankTree& rt2) {
-    Array<std::shared_ptr<TreeNode>> merged_list = mergeToList(rt1, rt2);
-    RankTree* res = listToRankTree(merged_list, rt1.scale);
-    updateMergedTree(res->root);
+template<int Width>
+BasicRankTree<Width>* BasicRankTree<Width>::merge(const BasicRankTree& rt1, const BasicRankTree& rt2) {
+    BasicRankTree* res = listToRankTree(mergeToList(rt1, rt2), rt1.scale);
+    updateMergedTree(res->root, mergeThreads(res->number_of_levels));
+    res->addLevelZero(rt1);
+    res->addLevelZero(rt2);
     return res;
 }
-/********************************** RANK FUNCTIONS **********************************/
-int RankTree::findUpperBound(std::shared_ptr<TreeNode>& root, const int level_id) {
+
+/**
+ * insert_level_node_aux: adds all the players of a detached level node to the tree in O(logn * scale).
+ * if the level already exists its counts are added to the existing node, otherwise the node itself is linked
+ * in as a new leaf. returns true if a new level was created.
+*/
+template<int Width>
+bool BasicRankTree<Width>::insert_level_node_aux(std::shared_ptr<Node>& root, const std::shared_ptr<Node>& level) {
     if(!root) {
-        return level_id+1;
+        root = level;
+        return true;
     }
-    if(root->level_id == level_id) {
-        return level_id;
+    bool created = false;
+    if(level->level_id < root->level_id) {
+        created = insert_level_node_aux(root->left, level);
     }
-    else if(root->level_id < level_id) {
-        if(root->right) {
-            int tmp = findUpperBound(root->right, level_id);
-            if(tmp > root->level_id && tmp <= level_id) {
-                return tmp;
-            }
-        }
-        return root->level_id;
+    else if(root->level_id < level->level_id) {
+        created = insert_level_node_aux(root->right, level);
     }
-    else {  // root->level_id > level_id
-        if(root->left) {
-            return findUpperBound(root->left, level_id);   
-        }
-        return root->level_id; // shouldnt happen
+    else {
+        root->players_in_level += level->players_in_level;
+        increase_counts(root->self_scores_hist, level->self_scores_hist, root->scale);
     }
-}
-
-int RankTree::findLowerBound(std::shared_ptr<TreeNode>& root, const int level_id) {
-    if(!root){
-        return level_id-1;
+    increase_counts(root->scores_hist, level->self_scores_hist, root->scale);
+    recalculate_sums(root);
+    balance_aux(root);
+    root->height = 1 + max(height(root->left), height(root->right));
+    return created;
+}
+
+/**
+ * merge: merges other into this tree, leaving other empty.
+ * when other is small compared to this tree, its levels are inserted one by one (small to large), which costs
+ * O(m*logn*scale) instead of rebuilding both trees in O((n+m)*scale). otherwise falls back to the linear merge.
+ * over any sequence of merges where the larger tree absorbs the smaller, every level is moved O(logn) times.
+*/
+template<int Width>
+void BasicRankTree<Width>::merge(BasicRankTree& other) {
+    int small = other.number_of_levels;
+    if(small * (height(root) + 1) > small + number_of_levels) {
+        BasicRankTree* res = merge(*this, other);  // O(n+m)
+        root = std::move(res->root);
+        number_of_levels = res->number_of_levels;
+        level_zero = std::move(res->level_zero);
+        Arena::destroy(res);
+        other.root = nullptr;
+        other.level_zero = nullptr;
+        other.number_of_levels = 0;
     }
-    if(root->level_id == level_id) {
-        return level_id;
+    else {
+        insertLevelsOf(other);
+    }
+}
+
+template<int Width>
+void BasicRankTree<Width>::insertLevelsOf(BasicRankTree& other) {
+    addLevelZero(other);
+    Array<std::shared_ptr<Node>> levels = other.getTreeAsList();  // O(m)
+    for(int i = 0; i <= levels.getSize(); ++i) {
+        std::shared_ptr<Node>& level = levels[i];
+        // detach the node so it can be linked into this tree as is if its level is new
+        level->left = nullptr;
+        level->right = nullptr;
+        level->height = 0;
+        level->scores_hist.copy(level->self_scores_hist, level->scale);
+        recalculate_sums(level);
+        if(insert_level_node_aux(root, level)) {  // O(logn*scale)
+            number_of_levels++;
+        }
     }
-    else if(root->level_id < level_id) {
-        if(root->right) {
-            return findLowerBound(root->right, level_id);
+    other.root = nullptr;
+    other.level_zero = nullptr;
+    other.number_of_levels = 0;
+}
+
+/**
+ * merge: merges any number of trees at once and returns the result, which may be one of the given trees.
+ * two trees (a single pending merge) go through merge(other). otherwise, if all but the largest tree are small, they
+ * are inserted into it level by level, and if not all the level lists are merged together and the tree is rebuilt
+ * once in O(n*log(#trees) + n*scale), instead of once per tree.
+*/
+template<int Width>
+std::shared_ptr<BasicRankTree<Width>> BasicRankTree<Width>::merge(const Array<std::shared_ptr<BasicRankTree>>& trees) {
+    int count = trees.getSize() + 1;
+    int largest = 0, total_levels = 0;
+    for(int i = 0; i < count; ++i) {
+        total_levels += trees[i]->number_of_levels;
+        if(trees[i]->number_of_levels > trees[largest]->number_of_levels) {
+            largest = i;
         }
-        return root->level_id; // shouldnt happen
     }
-    else {  // root->level_id > level_id
-        if(root->left) {
-            int tmp = findLowerBound(root->left, level_id);
-            if(tmp < root->level_id && tmp >= level_id) {
-                return tmp;
+    std::shared_ptr<BasicRankTree> res = trees[largest];
+    if(count == 2) {
+        res->merge(*trees[1-largest]);
+        return res;
+    }
+    int small = total_levels - res->number_of_levels;
+    if(small * (height(res->root) + 1) <= total_levels) {
+        for(int i = 0; i < count; ++i) {
+            if(i != largest) {
+                res->insertLevelsOf(*trees[i]);
             }
         }
-        return root->level_id;
+        return res;
+    }
+    int threads = mergeThreads(total_levels);
+    BasicRankTree* merged = listToRankTree(mergeToListAux(trees, 0, count-1, threads), res->scale);  // O(n*log(#trees))
+    updateMergedTree(merged->root, threads);  // O(n*scale)
+    for(int i = 0; i < count; ++i) {
+        merged->addLevelZero(*trees[i]);
+        trees[i]->root = nullptr;
+        trees[i]->level_zero = nullptr;
+        trees[i]->number_of_levels = 0;
+    }
+    return Arena::adopt(merged);
+}
+template<int Width>
+void BasicRankTree<Width>::addLevelZero(const BasicRankTree& other) {
+    // level zero is a single node outside of the tree, so its subtree counts are its own counts
+    if(!other.level_zero) {
+        return;
     }
+    level_zero->players_in_level += other.level_zero->players_in_level;
+    level_zero->players_in_subtree += other.level_zero->players_in_level;
+    increase_counts(level_zero->self_scores_hist, other.level_zero->self_scores_hist, scale);
+    increase_counts(level_zero->scores_hist, other.level_zero->self_scores_hist, scale);
 }
-int RankTree::getSubtreeAtScore(std::shared_ptr<TreeNode>& root, const int score) {
-    if(!root || score > MAX_SCORE || score < 0) {
+
+/********************************** RANK FUNCTIONS **********************************/
+template<int Width>
+int BasicRankTree<Width>::getSubtreeAtScore(const std::shared_ptr<Node>& root, const int score) {
+    if(!root || score >= root->scale || score < 0) {
         return 0;
     }
-    return root->scores_hist[score];
+    return root->scores_hist.get(score);
 }
-void RankTree::RankAndScoreRankAux(std::shared_ptr<TreeNode>& root, const int bound, const int score, int* const sum_players, int* const sum_score) {
+template<int Width>
+int BasicRankTree<Width>::getLevelAtScore(const std::shared_ptr<Node>& root, const int score) {
+    if(!root || score >= root->scale || score < 0) {
+        return 0;
+    }
+    return root->self_scores_hist.get(score);
+}
+template<int Width>
+void BasicRankTree<Width>::addLevelToRange(LevelRange* range, const Node* level, const int score) {
+    range->players += level->players_in_level;
+    range->sum_levels += (long long)level->level_id * level->players_in_level;
+    if(score >= 0 && score < level->scale) {
+        range->players_with_score += level->self_scores_hist.get(score);
+    }
+    if(range->scores_hist) {
+        level->self_scores_hist.addTo(range->scores_hist, level->scale);
+    }
+}
+
+template<int Width>
+void BasicRankTree<Width>::addSubtreeToRange(LevelRange* range, const Node* root, const int score) {
     if(!root) {
         return;
     }
-    if(root->level_id < bound) {
-        *sum_players += getPlayersInSubtree(root->left) + root->players_in_level;
-        *sum_score += getSubtreeAtScore(root, score) - getSubtreeAtScore(root->right, score);
-        RankAndScoreRankAux(root->right, bound, score, sum_players, sum_score);
+    range->players += root->players_in_subtree;
+    range->sum_levels += root->sum_levels_in_subtree;
+    if(score >= 0 && score < root->scale) {
+        range->players_with_score += root->scores_hist.get(score);
     }
-    else if (root->level_id > bound) {
-        RankAndScoreRankAux(root->left, bound, score, sum_players, sum_score);
-    }
-    else {
-        *sum_players += getPlayersInSubtree(root->left) + root->players_in_level;
-        *sum_score += getSubtreeAtScore(root, score) - getSubtreeAtScore(root->right, score);
+    if(range->scores_hist) {
+        root->scores_hist.addTo(range->scores_hist, root->scale);
     }
 }
 
-double RankTree::getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) {
-    update_zero_path(root);
-    int closest_lower = findLowerBound(root, lower);
-    int closest_upper = findUpperBound(root, upper);
-    if(closest_upper < closest_lower || upper < 0 || upper < lower) {
-        return -1;
+/**
+ * levelRangeAux: aggregates the levels in [lower, upper] in a single descent, O(logn).
+ * goes down to the split node (the first node inside the range), then walks down the two boundary paths below it:
+ * on the left path every node inside the range contributes itself and its whole right subtree,
+ * on the right path every node inside the range contributes itself and its whole left subtree.
+*/
+template<int Width>
+void BasicRankTree<Width>::levelRangeAux(const Node* root, const int lower, const int upper, const int score, LevelRange* range) {
+    const Node* split = root;
+    while(split && (split->level_id < lower || split->level_id > upper)) {
+        split = (split->level_id < lower) ? split->right.get() : split->left.get();
     }
-    else if(closest_upper == closest_lower) {
-        std::shared_ptr<TreeNode> level = findLevel(closest_upper);
-        if(level->players_in_level == 0) {
-            return 0;
+    if(!split) {
+        return;
+    }
+    addLevelToRange(range, split, score);
+    for(const Node* node = split->left.get(); node; ) {  // left boundary
+        if(node->level_id >= lower) {
+            addLevelToRange(range, node, score);
+            addSubtreeToRange(range, node->right.get(), score);
+            node = node->left.get();
+        }
+        else {
+            node = node->right.get();
+        }
+    }
+    for(const Node* node = split->right.get(); node; ) {  // right boundary
+        if(node->level_id <= upper) {
+            addLevelToRange(range, node, score);
+            addSubtreeToRange(range, node->left.get(), score);
+            node = node->right.get();
+        }
+        else {
+            node = node->left.get();
         }
-        return 100 * double(level->self_scores_hist[score]) / level->players_in_level;
     }
-    int rank_upper = 0, rank_lower = 0, rank_score_upper = 0, rank_score_lower = 0;
-    RankAndScoreRankAux(root, closest_upper, score, &rank_upper, &rank_score_upper);
-    RankAndScoreRankAux(root, closest_lower, score, &rank_lower, &rank_score_lower);
-    if(closest_lower >= lower || closest_lower == 0) {  // include lower bound in count
-        std::shared_ptr<TreeNode> level = findLevel(closest_lower);
-        rank_lower -= level->players_in_level;
-        rank_score_lower -= level->self_scores_hist[score];
+}
+
+template<int Width>
+LevelRange BasicRankTree<Width>::getLevelRange(const int lower, const int upper, const int score) const {
+    LevelRange range;
+    if(upper < lower) {
+        return range;
     }
-    if(rank_upper - rank_lower == 0) {
+    levelRangeAux(root.get(), lower, upper, score, &range);
+    if(lower <= 0 && upper >= 0) {
+        addLevelToRange(&range, level_zero.get(), score);
+    }
+    return range;
+}
+
+/**
+ * getScoreDistribution: fills hist (scale counters) with the number of players of every score in levels [lower, upper],
+ * in the same single descent as getLevelRange, O(logn*scale).
+*/
+template<int Width>
+LevelRange BasicRankTree<Width>::getScoreDistribution(const int lower, const int upper, int* hist) const {
+    Histogram::reset(hist, scale);
+    LevelRange range;
+    range.scores_hist = hist;
+    if(upper < lower) {
+        return range;
+    }
+    levelRangeAux(root.get(), lower, upper, -1, &range);
+    if(lower <= 0 && upper >= 0) {
+        addLevelToRange(&range, level_zero.get(), -1);
+    }
+    return range;
+}
+
+template<int Width>
+double BasicRankTree<Width>::getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const {
+    LevelRange range = getLevelRange(lower, upper, score);  // O(logn)
+    if(range.players == 0) {
         return -1;
     }
-    return 100 * double(rank_score_upper - rank_score_lower) / (rank_upper - rank_lower);
+    return 100 * double(range.players_with_score) / range.players;
 }
 
 /********************************** AVERAGE HIGHEST FUNCTIONS **********************************/
-double RankTree::averageHighestPlayerLevelByGroupAux(std::shared_ptr<TreeNode>& root, int m) {
-    if(!root) {
+template<int Width>
+long long BasicRankTree<Width>::sumHighestPlayerLevelsAux(const std::shared_ptr<Node>& root, int m) {
+    if(!root || m <= 0) {
         return 0;
     }
-    else if(root->players_in_subtree == m) {
-        return root->average_level_in_subtree;
+    else if(root->players_in_subtree <= m) {  // the rest of the m players are in level zero
+        return root->sum_levels_in_subtree;
     }
     if(getPlayersInSubtree(root->right) >= m) {
-        return averageHighestPlayerLevelByGroupAux(root->right, m);
+        return sumHighestPlayerLevelsAux(root->right, m);
     }
-    else {
-        int remaining = m - getPlayersInSubtree(root->right);
-        if(!root->right && root->players_in_level >= m) {
-            return root->level_id;
-        }
-        else if(!root->right || remaining > root->players_in_level) {
-            int m2 = remaining - root->players_in_level;
-            double sum_levels_r = double(getAverageLevelInSubtree(root->right) * getPlayersInSubtree(root->right) +
-                                  root->players_in_level * root->level_id);
-            double average_l = averageHighestPlayerLevelByGroupAux(root->left, m2);
-            return (sum_levels_r + (average_l * m2)) / m;
-        }
-        else {
-            // can complete to m with players in root
-            return double(getAverageLevelInSubtree(root->right) * getPlayersInSubtree(root->right) + remaining * root->level_id) / m;
-        }
+    int remaining = m - getPlayersInSubtree(root->right);
+    if(remaining <= root->players_in_level) {
+        // can complete to m with players in root
+        return sumOfLevelsInSubtree(root->right) + (long long)remaining * root->level_id;
     }
+    return sumOfLevelsInSubtree(root->right) + (long long)root->players_in_level * root->level_id +
+           sumHighestPlayerLevelsAux(root->left, remaining - root->players_in_level);
 }
 
-double RankTree::averageHighestPlayerLevelByGroup(int m) {
-    return averageHighestPlayerLevelByGroupAux(root, m);
+template<int Width>
+double BasicRankTree<Width>::averageHighestPlayerLevelByGroup(int m) const {
+    return double(sumHighestPlayerLevelsAux(root, m)) / m;
+}
+
+template<int Width>
+long long BasicRankTree<Width>::sumHighestPlayerLevels(int m) const {
+    return sumHighestPlayerLevelsAux(root, m);
+}
+
+template<int Width>
+int BasicRankTree<Width>::selectLevelAux(const std::shared_ptr<Node>& root, int k) {
+    if(!root) {
+        return 0;  // past the players in the tree, so the player is in level zero
+    }
+    if(getPlayersInSubtree(root->right) >= k) {
+        return selectLevelAux(root->right, k);
+    }
+    int remaining = k - getPlayersInSubtree(root->right);
+    if(remaining <= root->players_in_level) {
+        return root->level_id;
+    }
+    return selectLevelAux(root->left, remaining - root->players_in_level);
+}
+
+// selectLevel: the level of the k-th highest player (k = 1 is the highest), same descent as the average of the highest
+template<int Width>
+int BasicRankTree<Width>::selectLevel(int k) const {
+    return selectLevelAux(root, k);  // O(logn)
 }
 
 /********************************** AVERAGE HIGHEST FUNCTIONS **********************************/
 
-void RankTree::getPlayersBoundsAux(std::shared_ptr<TreeNode>& root, int score, int m, int* lower, int* upper) {
+template<int Width>
+void BasicRankTree<Width>::getPlayersBoundsAux(const std::shared_ptr<Node>& root, int score, int m, int* lower, int* upper) {
     if(!root) {
         return;
     }
@@ -588,70 +863,114 @@ void RankTree::getPlayersBoundsAux(std::shared_ptr<TreeNode>& root, int score, i
     else {
         int remaining = m - getPlayersInSubtree(root->right);
         if(root->players_in_level >= remaining) {
-            *lower += max(0, remaining - (root->players_in_level - root->self_scores_hist[score]));
-            *upper += min(remaining, root->self_scores_hist[score]);
+            *lower += max(0, remaining - (root->players_in_level - root->self_scores_hist.get(score)));
+            *upper += min(remaining, root->self_scores_hist.get(score));
             if(root->right) {
-                *lower += root->right->scores_hist[score];
-                *upper += root->right->scores_hist[score];
+                *lower += root->right->scores_hist.get(score);
+                *upper += root->right->scores_hist.get(score);
             }
         }
         else if(remaining > root->players_in_level) {
             int m2 = remaining - root->players_in_level;
-            *lower += root->scores_hist[score];
-            *upper += root->scores_hist[score];
+            *lower += root->scores_hist.get(score);
+            *upper += root->scores_hist.get(score);
             if(root->left) {
-                *lower -= root->left->scores_hist[score];
-                *upper -= root->left->scores_hist[score];
+                *lower -= root->left->scores_hist.get(score);
+                *upper -= root->left->scores_hist.get(score);
             }
             getPlayersBoundsAux(root->left, score, m2, lower, upper);
         }
     }
 }
 
-void RankTree::getPlayersBounds(int score, int m, int* lower, int* upper) {
-    getPlayersBoundsAux(root, score, m, lower, upper);
+template<int Width>
+void BasicRankTree<Width>::getPlayersBounds(int score, int m, int* lower, int* upper) const {
+    int in_tree = getPlayersInSubtree(root);
+    if(m <= in_tree) {
+        getPlayersBoundsAux(root, score, m, lower, upper);
+        return;
+    }
+    // all the players in the tree, and the rest from level zero
+    int remaining = m - in_tree;
+    int zero_at_score = getLevelAtScore(level_zero, score);
+    *lower += getSubtreeAtScore(root, score) + max(0, remaining - (level_zero->players_in_level - zero_at_score));
+    *upper += getSubtreeAtScore(root, score) + min(remaining, zero_at_score);
 }
 
 /************************************** PUBLIC MEMBER FUNCTUINS **************************************/
 
-RankTree::RankTree(int scale) : scale(scale), root(std::make_shared<TreeNode>(scale, 0)), number_of_levels(1), level_zero(root) { }
+template<int Width>
+BasicRankTree<Width>::BasicRankTree(int scale) : scale(scale), root(nullptr), number_of_levels(0), level_zero(Arena::makeShared<Node>(scale, 0)) { }
 
-const std::shared_ptr<TreeNode>& RankTree::findLevel(const int level_id) const {
+template<int Width>
+const std::shared_ptr<BasicTreeNode<Width>>& BasicRankTree<Width>::findLevel(const int level_id) const {
+    if(level_id == 0) {
+        return level_zero;
+    }
     return find_level_aux(root, level_id);
 }
 
-void RankTree::insert(std::shared_ptr<Player>& player) {
+template<int Width>
+void BasicRankTree<Width>::insert(std::shared_ptr<Player>& player) {
     if(player->level == 0) {
-        insert_player_aux(level_zero, 0, player);
+        insert_player_aux(level_zero, 0, player);  // O(1)
         return;
     }
     if(!findLevel(player->level)) {
-        update_zero_path(root);
-        insert_level_aux(root, player->level, player, root->scale);
+        insert_level_aux(root, player->level, player, scale);
         number_of_levels++;
         return;
     }
     insert_player_aux(root, player->level, player);
 }
 
-void RankTree::removePlayer(std::shared_ptr<Player>& player) {
-    std::shared_ptr<TreeNode> node = findLevel(player->level);  // O(logn)
+template<int Width>
+void BasicRankTree<Width>::removePlayer(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        remove_player_aux(level_zero, player);  // O(1)
+        return;
+    }
+    std::shared_ptr<Node> node = findLevel(player->level);  // O(logn)
     if(!node) {
         return;
     }
     remove_player_aux(root, player);  // O(logn)
-    if(node->players_in_level == 0 && node->level_id != 0) {
-        update_zero_path(root);
+    if(node->players_in_level == 0) {
         remove_level_aux(root, player->level);  // O(logn)
         number_of_levels--;
     }
 }
 
-int RankTree::getPlayersInTree() {
-    update_zero_path(root);
-    return root->players_in_subtree;
+// player->level is new_level. a level node is only created or deleted if the move needs it, otherwise the levels
+// are updated in place by a single descent, O(logn)
+template<int Width>
+void BasicRankTree<Width>::movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level) {
+    if(old_level == new_level) {
+        return;
+    }
+    if(old_level != 0 && new_level != 0) {
+        const std::shared_ptr<Node>& from = findLevel(old_level);  // O(logn)
+        if(from && from->players_in_level > 1 && findLevel(new_level)) {  // O(logn)
+            move_player_aux(root, old_level, new_level, player->score);  // O(logn)
+            return;
+        }
+    }
+    reinsertPlayer(*this, player, old_level, new_level);  // O(logn)
+}
+
+template<int Width>
+int BasicRankTree<Width>::getPlayersInTree() const {
+    return getPlayersInSubtree(root) + level_zero->players_in_level;
 }
 
-void RankTree::change_player_score(const int level, const int old_score, const int new_score) {
+template<int Width>
+void BasicRankTree<Width>::change_player_score(const int level, const int old_score, const int new_score) {
+    if(level == 0) {
+        change_player_score_aux(level_zero, level, old_score, new_score);
+        return;
+    }
     change_player_score_aux(root, level, old_score, new_score);
-}
\ No newline at end of file
+}
+
+template class BasicRankTree<0>;
+template class BasicRankTree<INLINE_SCORE_WIDTH>;
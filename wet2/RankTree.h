@@ -3,10 +3,22 @@
 #include "DynamicHashTable.h"
 #include "Player.h"
 #include "Array.h"
+#include "ScoreHistogram.h"
+#include "InlineHistogram.h"
 #include <memory>
+#include <type_traits>
 
 const int MAX_SCORE = 200;
 
+// the histogram width (scale+1) with its own RankTree instantiation, Init uses it for scales that fit and the runtime
+// width (sparse histograms) for larger ones. see BasicRankTree
+// there is no wider instantiation because a width of 32 only pays off when levels hold many players. measured with
+// bench/engine_bench on 1M players at scale 31: with 50 players per level it cut insert and score changes by ~35%,
+// with one player per level it took 213MB instead of 141MB and the distribution queries ~50% longer. at width 16
+// the worst case is small: 135MB instead of 129MB and distribution queries ~20% longer at scale 15 with one player per
+// level. Init can't know how many players a level will hold, so it takes the width with the small worst case
+const int INLINE_SCORE_WIDTH = 16;
+
 template<typename T>
 void swap(T& a, T& b) {
     T temp = a;
@@ -14,108 +26,166 @@ void swap(T& a, T& b) {
     b = temp;
 }
 
-struct TreeNode {
+// a level of a RankTree. Width is the histogram width known at compile time, 0 if only the runtime scale is known
+template<int Width>
+struct BasicTreeNode {
+    typedef typename std::conditional<Width == 0, ScoreHistogram, InlineHistogram<Width>>::type Hist;
+
     int level_id;
     int height = 0;
     int players_in_level;
     int scale;
-    double average_level_in_subtree;
-    int* scores_hist;
-    int* self_scores_hist;
+    long long sum_levels_in_subtree;
+    Hist scores_hist;  // sparse or dense (see ScoreHistogram), or inline when Width is known
+    Hist self_scores_hist;
     int players_in_subtree;
-    std::shared_ptr<TreeNode> left;
-    std::shared_ptr<TreeNode> right;
+    std::shared_ptr<BasicTreeNode> left;
+    std::shared_ptr<BasicTreeNode> right;
     
-    TreeNode(int scale, int level) : 
-        level_id(level), height(0), players_in_level(0), scale(scale), average_level_in_subtree(0),
-        scores_hist(new int[MAX_SCORE]{0}), self_scores_hist(new int[MAX_SCORE]{0}), players_in_subtree(0), left(nullptr), right(nullptr) { }
-    ~TreeNode() {
-        delete[] scores_hist;
-        delete[] self_scores_hist;
+    BasicTreeNode(int scale, int level) : 
+        level_id(level), height(0), players_in_level(0), scale(scale), sum_levels_in_subtree(0),
+        players_in_subtree(0), left(nullptr), right(nullptr) { }
+    ~BasicTreeNode() {
         left = nullptr;
         right = nullptr;
     }
-    void swap_data(TreeNode& other) {
+    void swap_data(BasicTreeNode& other) {
         swap<int>(level_id, other.level_id);
         swap<int>(height, other.height);
         swap<int>(players_in_level, other.players_in_level);
-        swap<int*>(scores_hist, other.scores_hist);
-        swap<int*>(self_scores_hist, other.self_scores_hist);
+        scores_hist.swap(other.scores_hist);
+        self_scores_hist.swap(other.self_scores_hist);
         swap<int>(players_in_subtree, other.players_in_subtree);
-        swap<double>(average_level_in_subtree, other.average_level_in_subtree);
+        swap<long long>(sum_levels_in_subtree, other.sum_levels_in_subtree);
         swap<int>(scale, other.scale);
     }
 };
 
-class RankTree {
+// the node of the runtime width, also used for level zero by the other engines
+typedef BasicTreeNode<0> TreeNode;
+
+// aggregates of the players in a range of levels
+struct LevelRange {
+    int players;
+    long long sum_levels;
+    int players_with_score;  // players in the range with the requested score
+    int* scores_hist;  // if not null, the full score histogram of the range is added to it
+
+    LevelRange() : players(0), sum_levels(0), players_with_score(0), scores_hist(nullptr) { }
+};
+
+// An AVL tree of levels, every node keeps the counts, level sums and score histograms of its subtree.
+// Width is the histogram width (scale+1) when it is known at compile time: the histograms are then kept inline in the
+// nodes and every histogram loop has a constant trip count. BasicRankTree<0> keeps the width at runtime with sparse
+// histograms and works for any scale. The instantiations are in RankTree.cpp.
+template<int Width>
+class BasicRankTree {
+    public:
+        typedef BasicTreeNode<Width> Node;
+        typedef typename Node::Hist Hist;
+
     private:
         static int max(const int a, const int b);
         static int min(const int a, const int b);
-        static int height(const std::shared_ptr<TreeNode>& root);
-        static int get_balance_factor(const std::shared_ptr<TreeNode>& root);
-        static void decrease_counts(const std::shared_ptr<TreeNode>& A, const std::shared_ptr<TreeNode>& B);
-        static void decrease_counts(int* A, int* B, int scale);
-        static void increase_counts(const std::shared_ptr<TreeNode>& A, const std::shared_ptr<TreeNode>& B);
-        static void increase_counts(int* A, int* B, int scale);
-        static double sumOfLevelsInSubtree(std::shared_ptr<TreeNode>& root);
-        static int getPlayersInSubtree(std::shared_ptr<TreeNode>& root);
-        static double getAverageLevelInSubtree(std::shared_ptr<TreeNode>& root);
-        static void recalculate_average(std::shared_ptr<TreeNode>& root);
-        static void RR_rotation(std::shared_ptr<TreeNode>& parent);
-        static void RL_rotation(std::shared_ptr<TreeNode>& parent);
-        static void LL_rotation(std::shared_ptr<TreeNode>& parent);
-        static void LR_rotation(std::shared_ptr<TreeNode>& parent);
-        static void balance_aux(std::shared_ptr<TreeNode>& root);
-        static const std::shared_ptr<TreeNode>& find_level_aux(const std::shared_ptr<TreeNode>& root, const int level_id);
-        static void insert_level_aux(std::shared_ptr<TreeNode>& root, const int level_id, const std::shared_ptr<Player>& player, int scale);
-        static void insert_player_aux(std::shared_ptr<TreeNode>& root, const int level_id, const std::shared_ptr<Player>& player);
-        static void remove_player_aux(std::shared_ptr<TreeNode>& root, std::shared_ptr<Player>& player);
-        static void remove_level_aux(std::shared_ptr<TreeNode>& root, const int level_id);
-        static void remove_level_and_fix_hist_aux(std::shared_ptr<TreeNode>& root, const int level_id, int* hist);
-
-        static void inorderToList(const std::shared_ptr<TreeNode>& root, Array<std::shared_ptr<TreeNode>>& list);
-        Array<std::shared_ptr<TreeNode>> getTreeAsList() const;
-        static std::shared_ptr<TreeNode> getTreeFromListAux(const Array<std::shared_ptr<TreeNode>>& list, int start, int end);
-        static RankTree* getTreeFromList(const Array<std::shared_ptr<TreeNode>>& list, int scale);
-        static Array<std::shared_ptr<TreeNode>> mergeToList(const RankTree& av1, const RankTree& avl2);
-        static Array<std::shared_ptr<TreeNode>> removeDuplicates(const Array<std::shared_ptr<TreeNode>>& list);
-        static RankTree* listToRankTree(const Array<std::shared_ptr<TreeNode>>& list, int scale);
-        static void updateMergedTree(std::shared_ptr<TreeNode>& root);
-        static void resetHistogram(int* histogram, int scale);
-
-        static int findUpperBound(std::shared_ptr<TreeNode>& root, const int level_id);
-        static int findLowerBound(std::shared_ptr<TreeNode>& root, const int level_id);
-        static void RankAndScoreRankAux(std::shared_ptr<TreeNode>& root, const int bound, const int score, int* const sum_players, int* const sum_score);
-        static int getSubtreeAtScore(std::shared_ptr<TreeNode>& root, const int score);
-
-        static double averageHighestPlayerLevelByGroupAux(std::shared_ptr<TreeNode>& root, int m);
-
-
-        static void change_player_score_aux(std::shared_ptr<TreeNode>& root, const int level, const int old_score, const int new_score);
-
-        static void getPlayersBoundsAux(std::shared_ptr<TreeNode>& root, int score, int m, int* lower, int* higher);
+        static int height(const std::shared_ptr<Node>& root);
+        static int get_balance_factor(const std::shared_ptr<Node>& root);
+        static void decrease_counts(const std::shared_ptr<Node>& A, const std::shared_ptr<Node>& B);
+        static void decrease_counts(Hist& A, const Hist& B, int scale);
+        static void increase_counts(const std::shared_ptr<Node>& A, const std::shared_ptr<Node>& B);
+        static void increase_counts(Hist& A, const Hist& B, int scale);
+        static void recalculate_histogram(std::shared_ptr<Node>& root);
+        static long long sumOfLevelsInSubtree(const std::shared_ptr<Node>& root);
+        static int getPlayersInSubtree(const std::shared_ptr<Node>& root);
+        static void recalculate_sums(std::shared_ptr<Node>& root);
+        static void RR_rotation(std::shared_ptr<Node>& parent);
+        static void RL_rotation(std::shared_ptr<Node>& parent);
+        static void LL_rotation(std::shared_ptr<Node>& parent);
+        static void LR_rotation(std::shared_ptr<Node>& parent);
+        static void balance_aux(std::shared_ptr<Node>& root);
+        static const std::shared_ptr<Node>& find_level_aux(const std::shared_ptr<Node>& root, const int level_id);
+        static void insert_level_aux(std::shared_ptr<Node>& root, const int level_id, const std::shared_ptr<Player>& player, int scale);
+        static void insert_player_aux(std::shared_ptr<Node>& root, const int level_id, const std::shared_ptr<Player>& player);
+        static void remove_player_aux(std::shared_ptr<Node>& root, std::shared_ptr<Player>& player);
+        static void remove_level_aux(std::shared_ptr<Node>& root, const int level_id);
+        static void remove_level_and_fix_hist_aux(std::shared_ptr<Node>& root, const int level_id, const Hist& hist);
+
+        static void inorderToList(const std::shared_ptr<Node>& root, Array<std::shared_ptr<Node>>& list);
+        Array<std::shared_ptr<Node>> getTreeAsList() const;
+        static int mergeThreads(int levels);
+        static std::shared_ptr<Node> getTreeFromListAux(Array<std::shared_ptr<Node>>& list, int start, int end, int threads);
+        static BasicRankTree* getTreeFromList(Array<std::shared_ptr<Node>>&& list, int scale);
+        static Array<std::shared_ptr<Node>> mergeToList(const BasicRankTree& av1, const BasicRankTree& avl2);
+        static Array<std::shared_ptr<Node>> mergeToListAux(const Array<std::shared_ptr<BasicRankTree>>& trees, int start, int end, int threads);
+        static Array<std::shared_ptr<Node>> removeDuplicates(Array<std::shared_ptr<Node>>&& list);
+        static BasicRankTree* listToRankTree(Array<std::shared_ptr<Node>>&& list, int scale);
+        static void updateMergedTree(std::shared_ptr<Node>& root, int threads);
+        static bool insert_level_node_aux(std::shared_ptr<Node>& root, const std::shared_ptr<Node>& level);
+        void insertLevelsOf(BasicRankTree& other);
+        void addLevelZero(const BasicRankTree& other);
+
+        static void addLevelToRange(LevelRange* range, const Node* level, const int score);
+        static void addSubtreeToRange(LevelRange* range, const Node* root, const int score);
+        static void levelRangeAux(const Node* root, const int lower, const int upper, const int score, LevelRange* range);
+        static int getSubtreeAtScore(const std::shared_ptr<Node>& root, const int score);
+        static int getLevelAtScore(const std::shared_ptr<Node>& root, const int score);
+
+        static long long sumHighestPlayerLevelsAux(const std::shared_ptr<Node>& root, int m);
+        static int selectLevelAux(const std::shared_ptr<Node>& root, int k);
+
+
+        static void change_player_score_aux(std::shared_ptr<Node>& root, const int level, const int old_score, const int new_score);
+        static void add_to_level_aux(std::shared_ptr<Node>& root, const int level, const int score, const int count);
+        static void move_player_aux(std::shared_ptr<Node>& root, const int old_level, const int new_level, const int score);
+
+        static void getPlayersBoundsAux(const std::shared_ptr<Node>& root, int score, int m, int* lower, int* higher);
 
     public:
         int scale;
-        std::shared_ptr<TreeNode> root;
-        int number_of_levels = 1;  // starts with level 0
-        std::shared_ptr<TreeNode> level_zero;
+        std::shared_ptr<Node> root;
+        int number_of_levels = 0;  // levels in the tree, level 0 is not counted
+        // players of level 0 are only counted here and never in the tree, so adding them never touches the tree
+        // and the queries add level zero's counts to the tree's counts instead of updating the tree's histograms
+        std::shared_ptr<Node> level_zero;
 
-        RankTree(int scale);
+        BasicRankTree(int scale);
 
-        int getPlayersInTree();
-        static void update_zero_path(std::shared_ptr<TreeNode>& root);
+        int getPlayersInTree() const;
 
-        const std::shared_ptr<TreeNode>& findLevel(const int level_id) const;
+        const std::shared_ptr<Node>& findLevel(const int level_id) const;
         void insert(std::shared_ptr<Player>& player);
         void removePlayer(std::shared_ptr<Player>& player);
-        static RankTree* merge(const RankTree& rt1, const RankTree& rt2);
-        double getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score);
-        double averageHighestPlayerLevelByGroup(int m);
+        static BasicRankTree* merge(const BasicRankTree& rt1, const BasicRankTree& rt2);
+        void merge(BasicRankTree& other);
+        static std::shared_ptr<BasicRankTree> merge(const Array<std::shared_ptr<BasicRankTree>>& trees);
+        LevelRange getLevelRange(const int lower, const int upper, const int score) const;
+        LevelRange getScoreDistribution(const int lower, const int upper, int* hist) const;
+        double getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const;
+        double averageHighestPlayerLevelByGroup(int m) const;
+        long long sumHighestPlayerLevels(int m) const;
+        int selectLevel(int k) const;
 
         void change_player_score(const int level, const int old_score, const int new_score);
+        void movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level);
 
-        void getPlayersBounds(int score, int m, int* lower, int* higher);
+        void getPlayersBounds(int score, int m, int* lower, int* higher) const;
 };
 
+typedef BasicRankTree<0> RankTree;
+
+// moves a player between levels by removing and inserting it, for the engines without a fused move.
+// player->level is new_level, and is old_level only while the player is removed
+template<class Tree>
+void reinsertPlayer(Tree& tree, std::shared_ptr<Player>& player, const int old_level, const int new_level) {
+    player->level = old_level;
+    tree.removePlayer(player);
+    player->level = new_level;
+    tree.insert(player);
+}
+
+// creates an empty tree of any engine, max_level is only passed to engines with a bounded level domain
+template<class Tree>
+std::shared_ptr<Tree> makeRankTree(int scale, int /* max_level */) {
+    return Arena::makeShared<Tree>(scale);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "ScoreHistogram.h"
+#include "Histogram.h"
+
+void ScoreHistogram::promote(int scale) {
+    dense = Arena::newArray<int>(scale);
+    for(int i = 0; i < size; ++i) {
+        dense[scores[i]] = counts[i];
+    }
+    size = 0;
+}
+
+void ScoreHistogram::demote() {
+    Arena::deleteArray(dense);
+    dense = nullptr;
+    size = 0;
+}
+
+void ScoreHistogram::removePair(int i) {
+    size--;
+    scores[i] = scores[size];
+    counts[i] = counts[size];
+}
+
+void ScoreHistogram::increase(int score, int count, int scale) {
+    COUNT_HISTOGRAM_UPDATE();
+    if(dense) {
+        dense[score] += count;
+        return;
+    }
+    for(int i = 0; i < size; ++i) {
+        if(scores[i] == score) {
+            counts[i] += count;
+            if(counts[i] <= 0) {
+                removePair(i);
+            }
+            return;
+        }
+    }
+    if(count <= 0) {
+        return;
+    }
+    if(size == SPARSE_HISTOGRAM_CAPACITY) {
+        promote(scale);
+        dense[score] += count;
+        return;
+    }
+    scores[size] = (unsigned char)score;
+    counts[size] = count;
+    size++;
+}
+
+void ScoreHistogram::add(const ScoreHistogram& other, int scale) {
+    if(other.dense) {
+        if(!dense) {
+            promote(scale);
+        }
+        Histogram::add(dense, other.dense, scale);
+        return;
+    }
+    for(int i = 0; i < other.size; ++i) {
+        increase(other.scores[i], other.counts[i], scale);
+    }
+}
+
+void ScoreHistogram::subtract(const ScoreHistogram& other, int scale) {
+    if(dense && other.dense) {
+        Histogram::subtract(dense, other.dense, scale);
+    }
+    else if(dense) {
+        for(int i = 0; i < other.size; ++i) {
+            dense[other.scores[i]] -= other.counts[i];
+            if(dense[other.scores[i]] < 0) {
+                dense[other.scores[i]] = 0;
+            }
+        }
+    }
+    else if(other.dense) {
+        for(int i = size-1; i >= 0; --i) {
+            counts[i] -= other.dense[scores[i]];
+            if(counts[i] <= 0) {
+                removePair(i);
+            }
+        }
+    }
+    else {
+        for(int i = 0; i < other.size; ++i) {
+            increase(other.scores[i], -other.counts[i], scale);
+        }
+    }
+}
+
+void ScoreHistogram::sum(const ScoreHistogram& self, const ScoreHistogram* left, const ScoreHistogram* right, int scale) {
+    if(!self.dense && !(left && left->dense) && !(right && right->dense)) {
+        // all sparse, the result is sparse again if it fits
+        reset();
+        add(self, scale);
+        if(left) {
+            add(*left, scale);
+        }
+        if(right) {
+            add(*right, scale);
+        }
+        return;
+    }
+    if(!dense) {
+        dense = Arena::newArray<int>(scale);
+        size = 0;
+    }
+    // the dense sources in a single pass, then the pairs of the sparse ones
+    Histogram::sum(dense, self.dense, left ? left->dense : nullptr, right ? right->dense : nullptr, scale);
+    const ScoreHistogram* sources[3] = {&self, left, right};
+    for(int j = 0; j < 3; ++j) {
+        if(sources[j] && !sources[j]->dense) {
+            sources[j]->addTo(dense, scale);
+        }
+    }
+}
+
+void ScoreHistogram::copy(const ScoreHistogram& other, int scale) {
+    if(other.dense) {
+        if(!dense) {
+            dense = Arena::newArray<int>(scale);
+        }
+        Histogram::copy(dense, other.dense, scale);
+        return;
+    }
+    demote();
+    for(int i = 0; i < other.size; ++i) {
+        scores[i] = other.scores[i];
+        counts[i] = other.counts[i];
+    }
+    size = other.size;
+}
+
+void ScoreHistogram::reset() {
+    demote();
+}
+
+void ScoreHistogram::addTo(int* hist, int scale) const {
+    if(dense) {
+        Histogram::add(hist, dense, scale);
+        return;
+    }
+    for(int i = 0; i < size; ++i) {
+        hist[scores[i]] += counts[i];
+    }
+}
+
+void ScoreHistogram::swap(ScoreHistogram& other) {
+    int* temp_dense = dense;
+    dense = other.dense;
+    other.dense = temp_dense;
+    int temp_size = size;
+    size = other.size;
+    other.size = temp_size;
+    for(int i = 0; i < SPARSE_HISTOGRAM_CAPACITY; ++i) {
+        unsigned char temp_score = scores[i];
+        scores[i] = other.scores[i];
+        other.scores[i] = temp_score;
+        int temp_count = counts[i];
+        counts[i] = other.counts[i];
+        other.counts[i] = temp_count;
+    }
+}
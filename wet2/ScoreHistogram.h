@@ -0,0 +1,66 @@
+#ifndef SCORE_HISTOGRAM_H
+#define SCORE_HISTOGRAM_H
+
+#include "Arena.h"
+
+// distinct scores a histogram keeps as inline (score, count) pairs before it switches to a dense array
+const int SPARSE_HISTOGRAM_CAPACITY = 6;
+
+// The score histogram of a RankTree node. Most levels hold a few players with two or three distinct scores, so a
+// histogram starts sparse: up to SPARSE_HISTOGRAM_CAPACITY unordered (score, count) pairs kept inside the node.
+// It is promoted to a dense array of scale counters once it needs more pairs, and only becomes sparse again when
+// it is recalculated (sum, copy or reset) into something that fits. Dense histograms use the Histogram kernels.
+// scale isn't stored, every function that may touch the dense array takes it.
+class ScoreHistogram {
+    private:
+        int* dense;  // scale counters, nullptr while the histogram is sparse
+        int size;  // pairs in use while sparse
+        unsigned char scores[SPARSE_HISTOGRAM_CAPACITY];  // scores are at most MAX_SCORE
+        int counts[SPARSE_HISTOGRAM_CAPACITY];
+
+        void promote(int scale);
+        void demote();
+        void removePair(int i);
+
+    public:
+        ScoreHistogram() : dense(nullptr), size(0) { }
+        ~ScoreHistogram() {
+            Arena::deleteArray(dense);
+        }
+        ScoreHistogram(const ScoreHistogram&) = delete;
+        ScoreHistogram& operator=(const ScoreHistogram&) = delete;
+
+        bool isDense() const {
+            return dense != nullptr;
+        }
+
+        int get(int score) const {
+            if(dense) {
+                return dense[score];
+            }
+            for(int i = 0; i < size; ++i) {
+                if(scores[i] == score) {
+                    return counts[i];
+                }
+            }
+            return 0;
+        }
+
+        // count may be negative, a sparse count that drops to 0 or below is removed (clamped like Histogram::subtract)
+        void increase(int score, int count, int scale);
+        // this += other
+        void add(const ScoreHistogram& other, int scale);
+        // this = max(0, this - other)
+        void subtract(const ScoreHistogram& other, int scale);
+        // this = self + left + right, nullptr children count as empty
+        void sum(const ScoreHistogram& self, const ScoreHistogram* left, const ScoreHistogram* right, int scale);
+        // this = other
+        void copy(const ScoreHistogram& other, int scale);
+        // this = 0
+        void reset();
+        // hist += this, hist is a dense array of scale counters
+        void addTo(int* hist, int scale) const;
+        void swap(ScoreHistogram& other);
+};
+
+#endif
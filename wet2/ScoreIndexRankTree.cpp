@@ -0,0 +1,248 @@
+#include "ScoreIndexRankTree.h"
+#include "Histogram.h"
+#include <climits>
+
+/********************************** HELPER FUNCTIONS **********************************/
+int ScoreIndexRankTree::min(const int a, const int b) {
+    return (a < b) ? a : b;
+}
+
+int ScoreIndexRankTree::max(const int a, const int b) {
+    return (a > b) ? a : b;
+}
+
+int ScoreIndexRankTree::countInRange(const LevelIndex& index, const int lower, const int upper) {
+    return index.countAtMost(upper) - ((lower > INT_MIN) ? index.countAtMost(lower-1) : 0);
+}
+
+long long ScoreIndexRankTree::sumInRange(const LevelIndex& index, const int lower, const int upper) {
+    return index.sumAtMost(upper) - ((lower > INT_MIN) ? index.sumAtMost(lower-1) : 0);
+}
+
+LevelIndex& ScoreIndexRankTree::getIndex(int score) {
+    return (score < 0) ? players_index : score_index[score];
+}
+
+/********************************** MERGE FUNCTIONS **********************************/
+class LevelCountComparator {
+    public:
+        bool operator()(const LevelCount& left, const LevelCount& right) {
+            return left.level_id < right.level_id;
+        }
+};
+
+// merges the lists of the index of score in trees[start..end] pairwise, equal levels are combined by buildFromList
+Array<LevelCount> ScoreIndexRankTree::mergeToListAux(const Array<std::shared_ptr<ScoreIndexRankTree>>& trees, int start, int end, int score) {
+    if(start == end) {
+        return trees[start]->getIndex(score).getAsList();
+    }
+    int mid = (start+end)/2;
+    LevelCountComparator cmp;
+    Array<LevelCount> list1 = mergeToListAux(trees, start, mid, score);
+    Array<LevelCount> list2 = mergeToListAux(trees, mid+1, end, score);
+    return Array<LevelCount>::merge(std::move(list1), std::move(list2), cmp);
+}
+
+void ScoreIndexRankTree::addLevelZero(const ScoreIndexRankTree& other) {
+    if(!other.level_zero) {
+        return;
+    }
+    level_zero->players_in_level += other.level_zero->players_in_level;
+    level_zero->self_scores_hist.add(other.level_zero->self_scores_hist, scale);
+}
+
+void ScoreIndexRankTree::clear() {
+    players_index.clear();
+    for(int s = 0; s < scale; ++s) {
+        score_index[s].clear();
+    }
+    level_zero = nullptr;
+}
+
+/**
+ * merge: merges other into this tree, leaving other empty. like RankTree::merge, a small tree is inserted level by
+ * level, otherwise the lists of every pair of indexes are merged and the indexes are rebuilt in linear time.
+*/
+void ScoreIndexRankTree::merge(ScoreIndexRankTree& other) {
+    int small = other.players_index.number_of_levels;
+    bool rebuild = small * (players_index.height() + 2) > small + players_index.number_of_levels;
+    LevelCountComparator cmp;
+    for(int score = -1; score < scale; ++score) {
+        LevelIndex& index = getIndex(score);
+        Array<LevelCount> other_list = other.getIndex(score).getAsList();
+        if(rebuild) {
+            index.buildFromList(Array<LevelCount>::merge(index.getAsList(), std::move(other_list), cmp));  // O(n+m)
+        }
+        else {
+            for(int i = 0; i <= other_list.getSize(); ++i) {
+                index.add(other_list[i].level_id, other_list[i].count);  // O(logn)
+            }
+        }
+    }
+    addLevelZero(other);
+    other.clear();
+}
+
+std::shared_ptr<ScoreIndexRankTree> ScoreIndexRankTree::merge(const Array<std::shared_ptr<ScoreIndexRankTree>>& trees) {
+    int count = trees.getSize() + 1;
+    int largest = 0, total_levels = 0;
+    for(int i = 0; i < count; ++i) {
+        total_levels += trees[i]->players_index.number_of_levels;
+        if(trees[i]->players_index.number_of_levels > trees[largest]->players_index.number_of_levels) {
+            largest = i;
+        }
+    }
+    std::shared_ptr<ScoreIndexRankTree> res = trees[largest];
+    int small = total_levels - res->players_index.number_of_levels;
+    if(small * (res->players_index.height() + 2) <= total_levels) {
+        for(int i = 0; i < count; ++i) {
+            if(i != largest) {
+                res->merge(*trees[i]);
+            }
+        }
+        return res;
+    }
+    for(int score = -1; score < res->scale; ++score) {
+        res->getIndex(score).buildFromList(mergeToListAux(trees, 0, count-1, score));  // O(n*log(#trees))
+    }
+    for(int i = 0; i < count; ++i) {
+        if(i != largest) {
+            res->addLevelZero(*trees[i]);
+            trees[i]->clear();
+        }
+    }
+    return res;
+}
+
+/********************************** RANK FUNCTIONS **********************************/
+LevelRange ScoreIndexRankTree::getLevelRange(const int lower, const int upper, const int score) const {
+    LevelRange range;
+    if(upper < lower) {
+        return range;
+    }
+    range.players = countInRange(players_index, lower, upper);  // O(logn)
+    range.sum_levels = sumInRange(players_index, lower, upper);  // O(logn)
+    if(score >= 0 && score < scale) {
+        range.players_with_score = countInRange(score_index[score], lower, upper);  // O(logn)
+    }
+    if(lower <= 0 && upper >= 0) {
+        range.players += level_zero->players_in_level;
+        range.players_with_score += (score >= 0 && score < scale) ? level_zero->self_scores_hist.get(score) : 0;
+    }
+    return range;
+}
+
+LevelRange ScoreIndexRankTree::getScoreDistribution(const int lower, const int upper, int* hist) const {
+    Histogram::reset(hist, scale);
+    LevelRange range = getLevelRange(lower, upper, -1);
+    range.scores_hist = hist;
+    if(upper < lower) {
+        return range;
+    }
+    for(int s = 0; s < scale; ++s) {
+        hist[s] = countInRange(score_index[s], lower, upper);  // O(scale*logn)
+    }
+    if(lower <= 0 && upper >= 0) {
+        level_zero->self_scores_hist.addTo(hist, scale);
+    }
+    return range;
+}
+
+double ScoreIndexRankTree::getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const {
+    LevelRange range = getLevelRange(lower, upper, score);  // O(logn)
+    if(range.players == 0) {
+        return -1;
+    }
+    return 100 * double(range.players_with_score) / range.players;
+}
+
+/********************************** AVERAGE HIGHEST FUNCTIONS **********************************/
+double ScoreIndexRankTree::averageHighestPlayerLevelByGroup(int m) const {
+    return double(sumHighestPlayerLevels(m)) / m;
+}
+
+long long ScoreIndexRankTree::sumHighestPlayerLevels(int m) const {
+    return players_index.sumHighest(m);  // O(logn), the rest of the players are in level zero
+}
+
+int ScoreIndexRankTree::selectLevel(int k) const {
+    return players_index.select(k);  // O(logn), 0 if the player is in level zero
+}
+
+void ScoreIndexRankTree::getPlayersBounds(int score, int m, int* lower, int* upper) const {
+    if(score < 0 || score >= scale || m <= 0) {
+        return;
+    }
+    const LevelIndex& at_score = score_index[score];
+    int in_tree = players_index.total();
+    if(m <= in_tree) {
+        // everyone above the level of the m-th highest player is taken, and some of the players in that level
+        int cut = players_index.select(m);  // O(logn)
+        int above = in_tree - players_index.countAtMost(cut);
+        int at_cut = players_index.countAt(cut);
+        int score_above = at_score.total() - at_score.countAtMost(cut);
+        int score_at_cut = at_score.countAt(cut);
+        int needed = m - above;
+        *lower += score_above + max(0, needed - (at_cut - score_at_cut));
+        *upper += score_above + min(needed, score_at_cut);
+        return;
+    }
+    // all the players in the indexes, and the rest from level zero
+    int remaining = m - in_tree;
+    int zero_at_score = level_zero->self_scores_hist.get(score);
+    *lower += at_score.total() + max(0, remaining - (level_zero->players_in_level - zero_at_score));
+    *upper += at_score.total() + min(remaining, zero_at_score);
+}
+
+/********************************** INTERFACE FUNCTIONS **********************************/
+ScoreIndexRankTree::ScoreIndexRankTree(int scale) :
+    scale(scale), players_index(), score_index(Arena::newArray<LevelIndex>(scale)), level_zero(Arena::makeShared<TreeNode>(scale, 0)) { }
+
+ScoreIndexRankTree::~ScoreIndexRankTree() {
+    Arena::deleteArray(score_index);
+}
+
+int ScoreIndexRankTree::getPlayersInTree() const {
+    return players_index.total() + level_zero->players_in_level;
+}
+
+int ScoreIndexRankTree::depth() const {
+    return players_index.height() + 1;
+}
+
+void ScoreIndexRankTree::insert(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level++;
+        level_zero->self_scores_hist.increase(player->score, 1, scale);
+        return;
+    }
+    players_index.add(player->level, 1);  // O(logn)
+    int path = score_index[player->score].add(player->level, 1);  // O(logn)
+    COUNT_HISTOGRAM_UPDATES(path);
+}
+
+void ScoreIndexRankTree::removePlayer(std::shared_ptr<Player>& player) {
+    if(player->level == 0) {
+        level_zero->players_in_level--;
+        level_zero->self_scores_hist.increase(player->score, -1, scale);
+        return;
+    }
+    players_index.add(player->level, -1);  // O(logn)
+    int path = score_index[player->score].add(player->level, -1);  // O(logn)
+    COUNT_HISTOGRAM_UPDATES(path);
+}
+
+void ScoreIndexRankTree::change_player_score(const int level, const int old_score, const int new_score) {
+    if(level == 0) {
+        level_zero->self_scores_hist.increase(old_score, -1, scale);
+        level_zero->self_scores_hist.increase(new_score, 1, scale);
+        return;
+    }
+    int path = score_index[old_score].add(level, -1);  // O(logn)
+    path += score_index[new_score].add(level, 1);  // O(logn)
+    COUNT_HISTOGRAM_UPDATES(path);
+}
+
+void ScoreIndexRankTree::movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level) {
+    reinsertPlayer(*this, player, old_level, new_level);  // O(logn)
+}
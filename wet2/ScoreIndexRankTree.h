@@ -0,0 +1,55 @@
+#ifndef SCORE_INDEX_RANKTREE_H
+#define SCORE_INDEX_RANKTREE_H
+#include "RankTree.h"
+#include "LevelIndex.h"
+#include "Player.h"
+#include "Array.h"
+#include <memory>
+
+// A RankTree with the same operations, laid out as one LevelIndex of all the players plus one LevelIndex per score.
+// Every node holds a single count instead of a histogram, so node size doesn't depend on scale: an update touches
+// two indexes (three for a score change) and a score query is two prefix counts on the index of that score.
+// Only the full score distribution of a range costs O(scale*logn), one range count per score.
+class ScoreIndexRankTree {
+    private:
+        static int min(const int a, const int b);
+        static int max(const int a, const int b);
+        static int countInRange(const LevelIndex& index, const int lower, const int upper);
+        static long long sumInRange(const LevelIndex& index, const int lower, const int upper);
+        LevelIndex& getIndex(int score);  // score -1 is the index of all the players
+        static Array<LevelCount> mergeToListAux(const Array<std::shared_ptr<ScoreIndexRankTree>>& trees, int start, int end, int score);
+        void addLevelZero(const ScoreIndexRankTree& other);
+        void clear();
+
+    public:
+        int scale;
+        LevelIndex players_index;
+        LevelIndex* score_index;  // scale indexes, score_index[s] counts the players of score s in every level
+        std::shared_ptr<TreeNode> level_zero;  // kept outside the indexes like in RankTree, only its self counts are used
+
+        ScoreIndexRankTree(int scale);
+        ~ScoreIndexRankTree();
+        ScoreIndexRankTree(const ScoreIndexRankTree&) = delete;
+        ScoreIndexRankTree& operator=(const ScoreIndexRankTree&) = delete;
+
+        int getPlayersInTree() const;
+        int depth() const;
+
+        void insert(std::shared_ptr<Player>& player);
+        void removePlayer(std::shared_ptr<Player>& player);
+        void merge(ScoreIndexRankTree& other);
+        static std::shared_ptr<ScoreIndexRankTree> merge(const Array<std::shared_ptr<ScoreIndexRankTree>>& trees);
+        LevelRange getLevelRange(const int lower, const int upper, const int score) const;
+        LevelRange getScoreDistribution(const int lower, const int upper, int* hist) const;
+        double getPercentOfPlayersWithScoreInBounds(const int lower, const int upper, const int score) const;
+        double averageHighestPlayerLevelByGroup(int m) const;
+        long long sumHighestPlayerLevels(int m) const;
+        int selectLevel(int k) const;
+
+        void change_player_score(const int level, const int old_score, const int new_score);
+        void movePlayer(std::shared_ptr<Player>& player, const int old_level, const int new_level);
+
+        void getPlayersBounds(int score, int m, int* lower, int* higher) const;
+};
+
+#endif
@@ -3,31 +3,33 @@
 
 #include "Group.h"
 #include "RankTree.h"
+#include "ConcurrentUF.h"
 #include <memory>
 
-class UF {
+// The serial forest of UF, union by size and two-pass path compression. only one thread may use it at a time.
+class SerialUF {
     private:
         int k;
         int* parent;
         int* size;
 
     public:
-        Group* groups;
-        UF(int k, int scale) : k(k), parent(new int[k]), size(new int[k]), groups(new Group[k]) {
+        SerialUF(int k) : k(k), parent(Arena::newArray<int>(k)), size(Arena::newArray<int>(k)) {
             for(int i=0; i<k; ++i) {
                 parent[i] = i;
                 size[i] = 1;
-                groups[i] = Group(i, scale);
             }
         }
-        
-        ~UF() {
-            delete[] parent;
-            delete[] groups;
-            delete[] size;
+
+        ~SerialUF() {
+            Arena::deleteArray(parent);
+            Arena::deleteArray(size);
         }
 
-        int Size() {
+        SerialUF(const SerialUF&) = delete;
+        SerialUF& operator=(const SerialUF&) = delete;
+
+        int Size() const {
             return k;
         }
 
@@ -50,14 +52,55 @@ class UF {
             if(size[group1] > size[group2]) {
                 parent[group2] = group1;
                 size[group1] += size[group2];
-                groups[group1].merge(groups[group2]);
                 return group1;
             }
             parent[group1] = group2;
             size[group2] += size[group1];
-            groups[group2].merge(groups[group1]);
-            return group2;   
+            return group2;
+        }
+};
+
+// the forest PlayersManager uses, build with -DWET2_CONCURRENT_UF to use ConcurrentUF instead of SerialUF.
+// the rest of the manager is not thread safe, so the commands still run one at a time in both modes
+#if defined(WET2_CONCURRENT_UF)
+typedef ConcurrentUF DefaultUF;
+#else
+typedef SerialUF DefaultUF;
+#endif
+
+// The groups 0..k-1 and the forest that unites them, Forest is SerialUF or ConcurrentUF.
+template<class Tree, class Forest = DefaultUF>
+class UF {
+    private:
+        Forest forest;
+
+    public:
+        Group<Tree>* groups;
+        UF(int k, int scale, int max_level) : forest(k), groups(Arena::newArray<Group<Tree>>(k)) {
+            for(int i=0; i<k; ++i) {
+                groups[i] = Group<Tree>(i, scale, max_level);
+            }
+        }
+        
+        ~UF() {
+            Arena::deleteArray(groups);
+        }
+
+        int Size() {
+            return forest.Size();
+        }
+
+        int Find(int id) {
+            return forest.Find(id);
+        }
+
+        int Union(int group1, int group2) {
+            // assums group1, group2 are roots of different groups
+            int root = forest.Union(group1, group2);
+            int absorbed = (root == group1) ? group2 : group1;
+            groups[root].merge(groups[absorbed]);
+            return root;
         }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,41 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// Helpers shared by the benchmark drivers. Every driver seeds its own generator, so runs are repeatable.
+
+// seconds since an arbitrary point, steady_clock so that runs can be compared
+inline double benchSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// xorshift generator, the drivers don't depend on the distribution of rand()
+class BenchRandom {
+    private:
+        unsigned long long state;
+
+    public:
+        explicit BenchRandom(unsigned long long seed) : state(seed*2654435761ULL + 1) { }
+
+        unsigned long long next() {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            return state;
+        }
+
+        // uniform in [low, high]
+        int range(int low, int high) {
+            return low + int(next() % (unsigned long long)(high - low + 1));
+        }
+};
+
+// the first command line argument as an int, or def if it is missing
+inline int benchArg(int argc, char** argv, int i, int def) {
+    return (argc > i) ? atoi(argv[i]) : def;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "Bench.h"
+#include "../Array.h"
+#include <memory>
+
+// Throughput of Array::merge (user-042), the merge of the linear tree merges in wet1 and wet2 (wet1's Array.h is the
+// same file). Two sorted arrays of shared_ptrs are merged with the moving merge at 1, 2, 4, ... up to max_threads
+// threads, best of three runs each. Merges under ARRAY_PARALLEL_MERGE_MIN elements always run on one thread.
+// usage: array_merge_bench [elements_per_array=2000000] [max_threads=hardware threads]
+
+struct Item {
+    int key;
+};
+
+static bool lessKey(const std::shared_ptr<Item>& a, const std::shared_ptr<Item>& b) {
+    return a->key < b->key;
+}
+
+static Array<std::shared_ptr<Item>> sortedList(int size, int first, int step) {
+    Array<std::shared_ptr<Item>> list(size);
+    for(int i = 0; i < size; ++i) {
+        std::shared_ptr<Item> item = std::make_shared<Item>();
+        item->key = first + i*step;
+        list.push_back(item);
+    }
+    return list;
+}
+
+int main(int argc, char** argv) {
+    int size = benchArg(argc, argv, 1, 2000000);
+    int max_threads = benchArg(argc, argv, 2, Parallel::threads());
+    printf("%d + %d elements, hardware threads %d\n", size, size, Parallel::threads());
+    for(int threads = 1; threads <= max_threads; threads *= 2) {
+        Parallel::setThreads(threads);
+        double best = 0;
+        for(int run = 0; run < 3; ++run) {
+            Array<std::shared_ptr<Item>> list1 = sortedList(size, 0, 2);
+            Array<std::shared_ptr<Item>> list2 = sortedList(size, 1, 2);
+            double start = benchSeconds();
+            Array<std::shared_ptr<Item>> merged = Array<std::shared_ptr<Item>>::merge(std::move(list1), std::move(list2), lessKey);
+            double time = benchSeconds() - start;
+            for(int i = 0; i < 2*size; ++i) {
+                if(merged[i]->key != i) {
+                    printf("bad merge at %d\n", i);
+                    return 1;
+                }
+            }
+            if(run == 0 || time < best) {
+                best = time;
+            }
+        }
+        printf("%2d threads: %6.1f M elements/s\n", threads, 2.0 * size / best / 1e6);
+    }
+    return 0;
+}
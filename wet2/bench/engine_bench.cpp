@@ -0,0 +1,125 @@
+#include "Bench.h"
+#include "../RankTree.h"
+#include "../BPlusRankTree.h"
+#include "../ScoreIndexRankTree.h"
+#include "../Histogram.h"
+#include <memory>
+
+// The RankTree engines used directly, without the manager (user-036, user-038): depth, memory and the time of every
+// operation on one tree. Every engine gets the same players and the same operations, in the same order.
+//   insert:  every player is inserted at a random level in 1..levels
+//   level+:  a random player moves up 1..50 levels
+//   score:   a random player gets a random score
+//   percent: a percent query on a random level range, followed by an average of the highest 1..1000 players
+//   distrib: the score distribution of a random level range
+// mem is what the tree's arena holds after the inserts. Build with -DWET2_COUNT_HISTOGRAM_UPDATES to also print the
+// histogram updates and rebuilds per insert, level+ and score operation of every engine (see Histogram.h).
+// usage: engine_bench [players=1000000] [levels=200000] [scale=200]
+
+static int depth(const RankTree& tree) {
+    return tree.root ? tree.root->height + 1 : 0;
+}
+
+static int depth(const BPlusRankTree& tree) {
+    return tree.depth();
+}
+
+static int depth(const ScoreIndexRankTree& tree) {
+    return tree.depth();
+}
+
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+// the histogram updates and rebuilds counted since the last call, per op
+struct HistogramWork {
+    long long updates = histogram_updates, rebuilds = histogram_rebuilds;
+    char text[3][32];
+    int phase = 0;
+
+    void take(int ops) {
+        snprintf(text[phase++], sizeof(text[0]), "%.1f/%.1f", double(histogram_updates - updates) / ops,
+                 double(histogram_rebuilds - rebuilds) / ops);
+        updates = histogram_updates;
+        rebuilds = histogram_rebuilds;
+    }
+};
+#endif
+
+template<class Tree>
+static void run(const char* name, int players, int levels, int scale) {
+    BenchRandom random(36);
+    Arena arena;
+    ArenaScope scope(&arena);
+    std::unique_ptr<std::shared_ptr<Player>[]> all(new std::shared_ptr<Player>[players]);
+    for(int i = 0; i < players; ++i) {
+        all[i] = std::make_shared<Player>(i+1, 1, random.range(1, scale), random.range(1, levels));
+    }
+    std::shared_ptr<Tree> tree = makeRankTree<Tree>(scale+1, levels);
+    std::size_t reserved = arena.getReserved();
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    HistogramWork work;
+#endif
+    double start = benchSeconds();
+    for(int i = 0; i < players; ++i) {
+        tree->insert(all[i]);
+    }
+    double inserted = benchSeconds();
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    work.take(players);
+#endif
+    double memory = double(arena.getReserved() - reserved) / (1024*1024);
+    int ops = players;
+    for(int i = 0; i < ops; ++i) {
+        std::shared_ptr<Player>& player = all[random.range(0, players-1)];
+        int old_level = player->level;
+        player->level += random.range(1, 50);
+        tree->movePlayer(player, old_level, player->level);
+    }
+    double moved = benchSeconds();
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    work.take(ops);
+#endif
+    for(int i = 0; i < ops; ++i) {
+        std::shared_ptr<Player>& player = all[random.range(0, players-1)];
+        int score = random.range(1, scale);
+        tree->change_player_score(player->level, player->score, score);
+        player->score = score;
+    }
+    double scored = benchSeconds();
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    work.take(ops);
+#endif
+    int queries = 200000;
+    double checksum = 0;
+    for(int i = 0; i < queries; ++i) {
+        int lower = random.range(0, levels);
+        checksum += tree->getPercentOfPlayersWithScoreInBounds(lower, lower + random.range(0, levels/4), random.range(1, scale));
+        checksum += tree->averageHighestPlayerLevelByGroup(random.range(1, 1000));
+    }
+    double queried = benchSeconds();
+    int distributions = 20000;
+    std::unique_ptr<int[]> hist(new int[scale+1]);
+    for(int i = 0; i < distributions; ++i) {
+        int lower = random.range(0, levels);
+        checksum += tree->getScoreDistribution(lower, lower + random.range(0, levels/4), hist.get()).players;
+    }
+    double distributed = benchSeconds();
+    printf("%-6s %5d %7.0f MB %8.2f %8.2f %8.2f %8.2f %8.2f   (%g)\n", name, depth(*tree), memory,
+           (inserted-start) * 1e6 / players, (moved-inserted) * 1e6 / ops, (scored-moved) * 1e6 / ops,
+           (queried-scored) * 1e6 / queries, (distributed-queried) * 1e6 / distributions, checksum);
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    printf("%-6s histogram updates/rebuilds per op: insert %s, level+ %s, score %s\n", name, work.text[0], work.text[1],
+           work.text[2]);
+#endif
+}
+
+int main(int argc, char** argv) {
+    int players = benchArg(argc, argv, 1, 1000000);
+    int levels = benchArg(argc, argv, 2, 200000);
+    int scale = benchArg(argc, argv, 3, 200);
+    printf("%d players, levels 1..%d, scale %d, us per op\n", players, levels, scale);
+    printf("engine depth      mem   insert   level+    score  percent  distrib\n");
+    run<RankTree>("avl", players, levels, scale);
+    run<BPlusRankTree>("bplus", players, levels, scale);
+    run<ScoreIndexRankTree>("index", players, levels, scale);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "Bench.h"
+#include "../Histogram.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TICKS() __rdtsc()
+#define BENCH_TICK_UNIT "cycles"
+#else
+#define BENCH_TICKS() (unsigned long long)(benchSeconds() * 1e9)
+#define BENCH_TICK_UNIT "ns"
+#endif
+
+// Cost of one call of every Histogram kernel at the scales RankTree uses (user-031), in cycles per call on x86 and
+// nanoseconds elsewhere. The scalar loops are what the kernels replaced: add, and reset followed by three adds
+// for the fused sum. A histogram has scale+1 counters, like in the trees.
+// usage: histogram_bench [calls=2000000]
+
+static const int WIDTH = 256;
+
+static void addScalar(int* dst, const int* src, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] += src[i];
+    }
+}
+
+static void sumScalar(int* dst, const int* self, const int* left, const int* right, int n) {
+    for(int i = 0; i < n; ++i) {
+        dst[i] = 0;
+    }
+    addScalar(dst, self, n);
+    addScalar(dst, left, n);
+    addScalar(dst, right, n);
+}
+
+// keeps the compiler from dropping or merging the calls
+static void touch(int* dst) {
+    asm volatile("" : : "r"(dst) : "memory");
+}
+
+template<class Call>
+static double ticksPerCall(int calls, Call call) {
+    unsigned long long start = BENCH_TICKS();
+    for(int i = 0; i < calls; ++i) {
+        call();
+    }
+    return double(BENCH_TICKS() - start) / calls;
+}
+
+int main(int argc, char** argv) {
+    int calls = benchArg(argc, argv, 1, 2000000);
+    static int self[WIDTH], left[WIDTH], right[WIDTH], dst[WIDTH];
+    for(int i = 0; i < WIDTH; ++i) {
+        self[i] = i;
+        left[i] = 2*i;
+        right[i] = 3*i;
+    }
+    printf("implementation: %s, %s per call\n", Histogram::implementation(), BENCH_TICK_UNIT);
+    printf("scale   add  (scalar)  subtract  reset  copy  sum  (reset+3 adds)\n");
+    const int scales[] = {10, 50, 200};
+    for(int scale : scales) {
+        int n = scale+1;
+        double add = ticksPerCall(calls, [&]() { Histogram::add(dst, self, n); touch(dst); });
+        double add_scalar = ticksPerCall(calls, [&]() { addScalar(dst, self, n); touch(dst); });
+        double subtract = ticksPerCall(calls, [&]() { Histogram::subtract(dst, self, n); touch(dst); });
+        double reset = ticksPerCall(calls, [&]() { Histogram::reset(dst, n); touch(dst); });
+        double copy = ticksPerCall(calls, [&]() { Histogram::copy(dst, self, n); touch(dst); });
+        double sum = ticksPerCall(calls, [&]() { Histogram::sum(dst, self, left, right, n); touch(dst); });
+        double sum_scalar = ticksPerCall(calls, [&]() { sumScalar(dst, self, left, right, n); touch(dst); });
+        printf("%5d %5.0f  (%5.0f)  %8.0f  %5.0f  %4.0f %4.0f  (%5.0f)\n", scale, add, add_scalar, subtract, reset, copy, sum, sum_scalar);
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "Bench.h"
+#include "../library2.h"
+#include "../Arena.h"
+#include <cstring>
+
+// SelectLevel and GetPercentOfPlayersWithScoreInBounds on a large tree (user-045), once with the arena on 4K pages
+// and once on huge pages (Arena::setHugePages). The queries are random, so most node visits miss the TLB on 4K pages.
+// AnonHugePages is the memory of the process on transparent huge pages while the manager is alive, it stays 0 where
+// the system has none and the arena falls back to the heap.
+// usage: huge_pages_bench [players=2000000] [queries=1000000]
+
+static const int GROUPS = 100;
+static const int SCALE = 200;
+
+// the AnonHugePages line of /proc/self/smaps_rollup in kB, -1 where there is none
+static long anonHugePages() {
+    long kb = -1;
+    FILE* smaps = fopen("/proc/self/smaps_rollup", "r");
+    if(!smaps) {
+        return kb;
+    }
+    char line[256];
+    while(fgets(line, sizeof(line), smaps)) {
+        if(strncmp(line, "AnonHugePages:", 14) == 0) {
+            kb = atol(line + 14);
+        }
+    }
+    fclose(smaps);
+    return kb;
+}
+
+static void run(bool huge_pages, int players, int queries) {
+    Arena::setHugePages(huge_pages);
+    BenchRandom random(45);
+    void* ds = Init(GROUPS, SCALE);
+    for(int id = 1; id <= players; ++id) {
+        AddPlayer(ds, id, random.range(1, GROUPS), random.range(1, SCALE));
+    }
+    for(int id = 1; id <= players; ++id) {
+        IncreasePlayerIDLevel(ds, id, random.range(1, 4*players));
+    }
+    double checksum = 0;
+    double start = benchSeconds();
+    for(int i = 0; i < queries; ++i) {
+        int level = 0;
+        SelectLevel(ds, 0, random.range(1, players), &level);
+        checksum += level;
+    }
+    double select_time = benchSeconds() - start;
+    start = benchSeconds();
+    for(int i = 0; i < queries; ++i) {
+        int lower = random.range(0, 4*players);
+        double percent = 0;
+        GetPercentOfPlayersWithScoreInBounds(ds, 0, random.range(1, SCALE), lower, lower + 1000, &percent);
+        checksum += percent;
+    }
+    double range_time = benchSeconds() - start;
+    printf("%-5s SelectLevel %.0f ns, range query %.0f ns, AnonHugePages %ld kB (checksum %.2f)\n",
+           huge_pages ? "huge" : "4K", select_time * 1e9 / queries, range_time * 1e9 / queries, anonHugePages(), checksum);
+    Quit(&ds);
+}
+
+int main(int argc, char** argv) {
+    int players = benchArg(argc, argv, 1, 2000000);
+    int queries = benchArg(argc, argv, 2, 1000000);
+    printf("%d players in %d groups, %d queries of each kind\n", players, GROUPS, queries);
+    run(false, players, queries);
+    run(true, players, queries);
+    return 0;
+}
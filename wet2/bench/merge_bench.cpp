@@ -0,0 +1,79 @@
+#include "Bench.h"
+#include "../library2.h"
+
+// MergeGroups on adversarial merge orders (user-027). Merges are deferred until the group is queried, so every
+// scenario queries the merged group to pay for the merge.
+//   chain:      one group with many levels absorbs many 3-player groups one by one, querying after every merge
+//   burst:      the same merges with a single query at the end, all the trees are merged at once
+//   tournament: equal groups merged pairwise, round after round, querying every merged group
+// usage: merge_bench [big_levels=100000] [small_groups=2000] [tournament_groups=4096]
+
+static const int SCALE = 20;
+
+static void query(void* ds, int group) {
+    double average;
+    AverageHighestPlayerLevelByGroup(ds, group, 1, &average);
+}
+
+static void fillBigGroup(void* ds, int group, int levels, int* next_id) {
+    for(int i = 1; i <= levels; ++i) {
+        AddPlayer(ds, *next_id, group, 1 + i % SCALE);
+        IncreasePlayerIDLevel(ds, (*next_id)++, i);  // a level per player
+    }
+}
+
+static void fillSmallGroups(void* ds, int first, int count, int players, BenchRandom& random, int* next_id) {
+    for(int group = first; group < first + count; ++group) {
+        for(int i = 0; i < players; ++i) {
+            AddPlayer(ds, *next_id, group, random.range(1, SCALE));
+            IncreasePlayerIDLevel(ds, (*next_id)++, random.range(1, 1000000));
+        }
+    }
+}
+
+static double chain(int big_levels, int small_groups, bool query_every_merge) {
+    BenchRandom random(27);
+    void* ds = Init(small_groups + 1, SCALE);
+    int next_id = 1;
+    fillBigGroup(ds, 1, big_levels, &next_id);
+    fillSmallGroups(ds, 2, small_groups, 3, random, &next_id);
+    query(ds, 1);
+    double start = benchSeconds();
+    for(int group = 2; group <= small_groups + 1; ++group) {
+        MergeGroups(ds, 1, group);
+        if(query_every_merge) {
+            query(ds, 1);
+        }
+    }
+    query(ds, 1);
+    double time = benchSeconds() - start;
+    Quit(&ds);
+    return time;
+}
+
+static double tournament(int groups) {
+    BenchRandom random(27);
+    void* ds = Init(groups, SCALE);
+    int next_id = 1;
+    fillSmallGroups(ds, 1, groups, 25, random, &next_id);
+    double start = benchSeconds();
+    for(int step = 1; step < groups; step *= 2) {
+        for(int group = 1; group + step <= groups; group += 2*step) {
+            MergeGroups(ds, group, group + step);
+            query(ds, group);
+        }
+    }
+    double time = benchSeconds() - start;
+    Quit(&ds);
+    return time;
+}
+
+int main(int argc, char** argv) {
+    int big_levels = benchArg(argc, argv, 1, 100000);
+    int small_groups = benchArg(argc, argv, 2, 2000);
+    int tournament_groups = benchArg(argc, argv, 3, 4096);
+    printf("chain      %d levels absorb %d groups: %.3fs\n", big_levels, small_groups, chain(big_levels, small_groups, true));
+    printf("burst      %d levels absorb %d groups: %.3fs\n", big_levels, small_groups, chain(big_levels, small_groups, false));
+    printf("tournament %d groups of 25 players:     %.3fs\n", tournament_groups, tournament(tournament_groups));
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "Bench.h"
+#include "../library2.h"
+#include "../Histogram.h"
+
+// IncreasePlayerIDLevel on a filled manager (user-050): players move up 1..3 levels, so most moves stay close to
+// their old level. Build with -DWET2_COUNT_HISTOGRAM_UPDATES to also count the histogram updates of every move.
+// usage: move_bench [players=500000] [levels=1000] [scale=10] [moves=2000000]
+
+static const int GROUPS = 64;
+
+int main(int argc, char** argv) {
+    int players = benchArg(argc, argv, 1, 500000);
+    int levels = benchArg(argc, argv, 2, 1000);
+    int scale = benchArg(argc, argv, 3, 10);
+    int moves = benchArg(argc, argv, 4, 2000000);
+    BenchRandom random(50);
+    void* ds = Init(GROUPS, scale);
+    for(int id = 1; id <= players; ++id) {
+        AddPlayer(ds, id, random.range(1, GROUPS), random.range(1, scale));
+        IncreasePlayerIDLevel(ds, id, random.range(1, levels));
+    }
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    long long updates = histogram_updates;
+#endif
+    double start = benchSeconds();
+    for(int i = 0; i < moves; ++i) {
+        IncreasePlayerIDLevel(ds, random.range(1, players), random.range(1, 3));
+    }
+    double time = benchSeconds() - start;
+    double average = 0;
+    AverageHighestPlayerLevelByGroup(ds, 0, 10, &average);
+    printf("%d players, levels 1..%d, scale %d: %.2f us per move", players, levels, scale, time * 1e6 / moves);
+#ifdef WET2_COUNT_HISTOGRAM_UPDATES
+    printf(", %.1f histogram updates per move", double(histogram_updates - updates) / moves);
+#endif
+    printf(" (checksum %.2f)\n", average);
+    Quit(&ds);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include "Bench.h"
+#include "../library2.h"
+
+// Latency of GetPercentOfPlayersWithScoreInBounds on a deep tree (user-033): every player is on its own level,
+// and the queries ask for random level ranges and scores of the all players tree and of a group tree.
+// usage: query_bench [players=1000000] [queries=2000000]
+
+static const int SCALE = 20;
+
+int main(int argc, char** argv) {
+    int players = benchArg(argc, argv, 1, 1000000);
+    int queries = benchArg(argc, argv, 2, 2000000);
+    BenchRandom random(33);
+    void* ds = Init(1, SCALE);
+    for(int id = 1; id <= players; ++id) {
+        AddPlayer(ds, id, 1, 1 + id % SCALE);
+        IncreasePlayerIDLevel(ds, id, id);
+    }
+    double checksum = 0;
+    for(int group = 0; group <= 1; ++group) {
+        double start = benchSeconds();
+        for(int i = 0; i < queries; ++i) {
+            int lower = random.range(1, players);
+            int higher = random.range(lower, players);
+            double percent = 0;
+            GetPercentOfPlayersWithScoreInBounds(ds, group, random.range(1, SCALE), lower, higher, &percent);
+            checksum += percent;
+        }
+        double time = benchSeconds() - start;
+        printf("group %d: %d levels, %.0f ns per query\n", group, players, time * 1e9 / queries);
+    }
+    printf("checksum %.2f\n", checksum);
+    Quit(&ds);
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "Bench.h"
+#include "../UF.h"
+#include "../Parallel.h"
+#include <memory>
+
+// Find/Union throughput of the forests of UF (user-029). The same list of operations, a quarter of them Unions of two
+// random ids and the rest Finds of a random id, runs on SerialUF on one thread and on ConcurrentUF split between
+// 1, 2, 4, ... up to max_threads threads. Every run ends with the same groups whatever the order of the Unions, so
+// the number of groups must match the serial run.
+// usage: uf_bench [ids=1048576] [ops=4000000] [max_threads=hardware threads]
+
+struct Op {
+    int a;
+    int b;  // -1 for a Find
+};
+
+template<class Forest>
+static int countGroups(Forest& forest) {
+    int count = 0;
+    for(int i = 0; i < forest.Size(); ++i) {
+        count += (forest.Find(i) == i);
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    int ids = benchArg(argc, argv, 1, 1 << 20);
+    int ops = benchArg(argc, argv, 2, 4000000);
+    int max_threads = benchArg(argc, argv, 3, Parallel::threads());
+    BenchRandom random(29);
+    std::unique_ptr<Op[]> list(new Op[ops]);
+    for(int i = 0; i < ops; ++i) {
+        list[i].a = random.range(0, ids-1);
+        list[i].b = (random.range(0, 3) == 0) ? random.range(0, ids-1) : -1;
+    }
+    printf("%d ids, %d ops (a quarter Unions), hardware threads %d\n", ids, ops, Parallel::threads());
+
+    SerialUF serial(ids);
+    long long checksum = 0;
+    double start = benchSeconds();
+    for(int i = 0; i < ops; ++i) {
+        int root1 = serial.Find(list[i].a);
+        if(list[i].b >= 0) {
+            int root2 = serial.Find(list[i].b);
+            if(root1 != root2) {
+                serial.Union(root1, root2);
+            }
+        }
+        checksum += root1;
+    }
+    double time = benchSeconds() - start;
+    int groups = countGroups(serial);
+    printf("serial      1 thread : %7.1f Mops/s, %d groups (%lld)\n", ops / time / 1e6, groups, checksum);
+
+    for(int threads = 1; threads <= max_threads; threads *= 2) {
+        ConcurrentUF forest(ids);
+        start = benchSeconds();
+        Parallel::forEachChunk(threads, [&](int chunk) {
+            int end = (long long)ops * (chunk+1) / threads;
+            for(int i = (long long)ops * chunk / threads; i < end; ++i) {
+                if(list[i].b >= 0) {
+                    forest.Union(list[i].a, list[i].b);
+                }
+                else {
+                    forest.Find(list[i].a);
+                }
+            }
+        });
+        time = benchSeconds() - start;
+        int concurrent_groups = countGroups(forest);
+        printf("concurrent %2d threads: %7.1f Mops/s, %d groups%s\n", threads, ops / time / 1e6, concurrent_groups,
+               (concurrent_groups == groups) ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -1,12 +1,44 @@
 #include "library2.h"
 #include "PlayersManager.h"
 
+// the default engine keeps the histograms of small scales inline in the nodes, with the width fixed at compile time.
+// wider inline histograms cost more than they save once most levels hold a few players, so larger scales stay sparse
+static PlayersManager* createDefault(int k, int scale) {
+#if !defined(WET2_BPLUS_RANKTREE) && !defined(WET2_SCORE_INDEX_RANKTREE)
+    if(scale+1 <= INLINE_SCORE_WIDTH) {
+        return PlayersManager::create<BasicPlayersManager<BasicRankTree<INLINE_SCORE_WIDTH>>>(k, scale);
+    }
+#endif
+    return PlayersManager::create<DefaultPlayersManager>(k, scale);
+}
+
 void* Init(int k, int scale) {
     if(k <=0 || scale > 200 || scale <= 0) {
         return nullptr;
     }
-    PlayersManager *DS = new PlayersManager(k, scale);
-    return (void*)DS;
+    try {
+        PlayersManager *DS = createDefault(k, scale);
+        return (void*)DS;
+    }
+    catch(const std::bad_alloc& e) {
+        return nullptr;
+    }
+}
+
+void* InitWithMaxLevel(int k, int scale, int maxLevel) {
+    if(k <=0 || scale > 200 || scale <= 0 || maxLevel <= 0) {
+        return nullptr;
+    }
+    if((long long)(maxLevel+1LL) * (scale+1) > MAX_FENWICK_COUNTERS) {  // the tree of all the players is dense
+        return nullptr;
+    }
+    try {
+        PlayersManager *DS = PlayersManager::create<BoundedPlayersManager>(k, scale, maxLevel);
+        return (void*)DS;
+    }
+    catch(const std::bad_alloc& e) {
+        return nullptr;
+    }
 }
 
 StatusType MergeGroups(void *DS, int GroupID1, int GroupID2) {
@@ -20,7 +52,26 @@ StatusType AddPlayer(void* DS, int PlayerID, int GroupID, int score) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
     }
-    return (StatusType)((PlayersManager*)DS)->addPlayer(PlayerID, GroupID, score);
+    return (StatusType)((PlayersManager*)DS)->addPlayer(PlayerID, GroupID, score, nullptr);
+}
+
+StatusType AddPlayerWithHandle(void* DS, int PlayerID, int GroupID, int score, PlayerHandle* Handle) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    PlayerHandles::Handle handle = 0;
+    StatusType res = (StatusType)((PlayersManager*)DS)->addPlayer(PlayerID, GroupID, score, Handle ? &handle : nullptr);
+    if(Handle && res == StatusType::SUCCESS) {
+        *Handle = handle;
+    }
+    return res;
+}
+
+StatusType RemovePlayerByHandle(void* DS, PlayerHandle Handle) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->removePlayerByHandle(Handle);
 }
 
 StatusType RemovePlayer(void* DS, int PlayerID) {
@@ -37,6 +88,13 @@ StatusType IncreasePlayerIDLevel(void* DS, int PlayerID, int LevelIncrease) {
     return (StatusType)((PlayersManager*)DS)->increasePlayerIDLevel(PlayerID, LevelIncrease);
 }
 
+StatusType IncreasePlayerLevelByHandle(void* DS, PlayerHandle Handle, int LevelIncrease) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->increasePlayerLevelByHandle(Handle, LevelIncrease);
+}
+
 StatusType ChangePlayerIDScore(void* DS, int PlayerID, int NewScore) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -44,6 +102,13 @@ StatusType ChangePlayerIDScore(void* DS, int PlayerID, int NewScore) {
     return (StatusType)((PlayersManager*)DS)->changePlayerIDScore(PlayerID, NewScore);
 }
 
+StatusType ChangePlayerScoreByHandle(void* DS, PlayerHandle Handle, int NewScore) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->changePlayerScoreByHandle(Handle, NewScore);
+}
+
 StatusType GetPercentOfPlayersWithScoreInBounds(void* DS, int GroupID, int score, int lowerlevel, int higherlevel, double* players) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -51,6 +116,20 @@ StatusType GetPercentOfPlayersWithScoreInBounds(void* DS, int GroupID, int score
     return (StatusType)((PlayersManager*)DS)->getPercentOfPlayersWithScoreInBounds(GroupID, score, lowerlevel, higherlevel, players);
 }
 
+StatusType GetScoreDistributionInBounds(void* DS, int GroupID, int lowerlevel, int higherlevel, int* counts) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->getScoreDistributionInBounds(GroupID, lowerlevel, higherlevel, counts);
+}
+
+StatusType GetPercentOfPlayersWithScoreRangeInBounds(void* DS, int GroupID, int lowerscore, int higherscore, int lowerlevel, int higherlevel, double* players) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->getPercentOfPlayersWithScoreRangeInBounds(GroupID, lowerscore, higherscore, lowerlevel, higherlevel, players);
+}
+
 StatusType AverageHighestPlayerLevelByGroup(void* DS, int GroupID, int m, double* avgLevel) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -58,6 +137,27 @@ StatusType AverageHighestPlayerLevelByGroup(void* DS, int GroupID, int m, double
     return (StatusType)((PlayersManager*)DS)->averageHighestPlayerLevelByGroup(GroupID, m, avgLevel);
 }
 
+StatusType SelectLevel(void* DS, int GroupID, int k, int* level) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->selectLevel(GroupID, k, level);
+}
+
+StatusType LevelPercentile(void* DS, int GroupID, double p, int* level) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->levelPercentile(GroupID, p, level);
+}
+
+StatusType AverageLevelInRankRange(void* DS, int GroupID, int r1, int r2, double* avgLevel) {
+    if(!DS) {
+        return StatusType::INVALID_INPUT;
+    }
+    return (StatusType)((PlayersManager*)DS)->averageLevelInRankRange(GroupID, r1, r2, avgLevel);
+}
+
 StatusType GetPlayersBound(void *DS, int GroupID, int score, int m, int * LowerBoundPlayers, int * HigherBoundPlayers) {
     if(!DS) {
         return StatusType::INVALID_INPUT;
@@ -69,6 +169,6 @@ void Quit(void** DS) {
     if(!DS) {
         return;
     }
-    delete (PlayersManager*)(*DS);
+    PlayersManager::destroy((PlayersManager*)(*DS));  // frees the manager's arena at once
     *DS = nullptr;
 }
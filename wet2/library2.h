@@ -30,10 +30,29 @@ typedef enum {
 
 void *Init(int k, int scale);
 
+// like Init, for inputs whose levels are known to stay in 0..maxLevel (higher levels are capped at maxLevel).
+// the levels of all the players are kept in a Fenwick tree of O(maxLevel*scale) memory, the groups are kept like in
+// Init. fails if (maxLevel+1)*(scale+1) is over MAX_FENWICK_COUNTERS (FenwickRankTree.h).
+void *InitWithMaxLevel(int k, int scale, int maxLevel);
+
 StatusType MergeGroups(void *DS, int GroupID1, int GroupID2);
 
 StatusType AddPlayer(void *DS, int PlayerID, int GroupID, int score);
 
+/* a handle of a player. 0 is never a valid handle */
+typedef unsigned long long PlayerHandle;
+
+/* like AddPlayer, and sets *Handle (if not NULL) to the new player's handle. the ByHandle functions take the handle
+ * instead of the id. once the player is removed they return FAILURE for its handle, even if a new player got the same
+ * id, and INVALID_INPUT for the handle 0 */
+StatusType AddPlayerWithHandle(void *DS, int PlayerID, int GroupID, int score, PlayerHandle *Handle);
+
+StatusType RemovePlayerByHandle(void *DS, PlayerHandle Handle);
+
+StatusType IncreasePlayerLevelByHandle(void *DS, PlayerHandle Handle, int LevelIncrease);
+
+StatusType ChangePlayerScoreByHandle(void *DS, PlayerHandle Handle, int NewScore);
+
 StatusType RemovePlayer(void *DS, int PlayerID);
 
 StatusType IncreasePlayerIDLevel(void *DS, int PlayerID, int LevelIncrease);
@@ -43,8 +62,23 @@ StatusType ChangePlayerIDScore(void *DS, int PlayerID, int NewScore);
 StatusType GetPercentOfPlayersWithScoreInBounds(void *DS, int GroupID, int score, int lowerLevel, int higherLevel,
                                             double * players);
 
+/* counts must hold scale entries, counts[s-1] is set to the number of players with score s in the level range */
+StatusType GetScoreDistributionInBounds(void *DS, int GroupID, int lowerLevel, int higherLevel, int * counts);
+
+StatusType GetPercentOfPlayersWithScoreRangeInBounds(void *DS, int GroupID, int lowerScore, int higherScore,
+                                                 int lowerLevel, int higherLevel, double * players);
+
 StatusType AverageHighestPlayerLevelByGroup(void *DS, int GroupID, int m, double * level);
 
+/* level of the k-th highest player in the group, k = 1 is the highest */
+StatusType SelectLevel(void *DS, int GroupID, int k, int * level);
+
+/* lowest level such that at least p percent of the group's players are at or below it, 0 <= p <= 100 */
+StatusType LevelPercentile(void *DS, int GroupID, double p, int * level);
+
+/* average level of the players ranked r1..r2 by level in the group, rank 1 is the highest */
+StatusType AverageLevelInRankRange(void *DS, int GroupID, int r1, int r2, double * level);
+
 StatusType GetPlayersBound(void *DS, int GroupID, int score, int m,
                                          int * LowerBoundPlayers, int * HigherBoundPlayers);
 
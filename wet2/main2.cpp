@@ -38,10 +38,16 @@ typedef enum {
     GETPERCENTOFPLAYERSWITHSCOREINBOUNDS_CMD = 6,
     AVERAGEHIGHESTPLAYERLEVELBYGROUP_CMD = 7,
     GETPLAYERSBOUND_CMD = 8,
-    QUIT_CMD = 9
+    QUIT_CMD = 9,
+    GETSCOREDISTRIBUTIONINBOUNDS_CMD = 10,
+    GETPERCENTOFPLAYERSWITHSCORERANGEINBOUNDS_CMD = 11,
+    SELECTLEVEL_CMD = 12,
+    LEVELPERCENTILE_CMD = 13,
+    AVERAGELEVELINRANKRANGE_CMD = 14,
+    INITWITHMAXLEVEL_CMD = 15
 } commandType;
 
-static const int numActions = 10;
+static const int numActions = 16;
 static const char *commandStr[] = {
         "Init",
         "MergeGroups",
@@ -52,7 +58,13 @@ static const char *commandStr[] = {
         "GetPercentOfPlayersWithScoreInBounds",
         "AverageHighestPlayerLevelByGroup",
         "GetPlayersBound",
-        "Quit" };
+        "Quit",
+        "GetScoreDistributionInBounds",
+        "GetPercentOfPlayersWithScoreRangeInBounds",
+        "SelectLevel",
+        "LevelPercentile",
+        "AverageLevelInRankRange",
+        "InitWithMaxLevel" };
 
 static const char* ReturnValToStr(int val) {
     switch (val) {
@@ -84,6 +96,7 @@ static errorType parser(const char* const command);
 if ( (read_parameters)!=(required_parameters) ) { printf(ErrorString); return error; }
 
 static bool isInit = false;
+static int initScale = 0;
 
 /***************************************************************************/
 /* main                                                                    */
@@ -115,7 +128,8 @@ static commandType CheckCommand(const char* const command,
         return (COMMENT_CMD);
     };
     for (int index = 0; index < numActions; index++) {
-        if (StrCmp(commandStr[index], command)) {
+        // the name must be followed by its arguments, so "Init" doesn't match "InitWithMaxLevel"
+        if (StrCmp(commandStr[index], command) && strchr(" \r\n", command[strlen(commandStr[index])])) {
             *command_arg = command + strlen(commandStr[index]) + 1;
             return ((commandType) index);
         };
@@ -137,6 +151,12 @@ static errorType OnGetPercentOfPlayersWithScoreInBounds(void* DS, const char* co
 static errorType OnAverageHighestPlayerLevelByGroup(void* DS, const char* const command);
 static errorType OnGetPlayersBound(void* DS, const char* const command);
 static errorType OnQuit(void** DS, const char* const command);
+static errorType OnGetScoreDistributionInBounds(void* DS, const char* const command);
+static errorType OnGetPercentOfPlayersWithScoreRangeInBounds(void* DS, const char* const command);
+static errorType OnSelectLevel(void* DS, const char* const command);
+static errorType OnLevelPercentile(void* DS, const char* const command);
+static errorType OnAverageLevelInRankRange(void* DS, const char* const command);
+static errorType OnInitWithMaxLevel(void** DS, const char* const command);
 
 /***************************************************************************/
 /* Parser                                                                  */
@@ -181,6 +201,24 @@ static errorType parser(const char* const command) {
         case (QUIT_CMD):
             rtn_val = OnQuit(&DS, command_args);
             break;
+        case (GETSCOREDISTRIBUTIONINBOUNDS_CMD):
+            rtn_val = OnGetScoreDistributionInBounds(DS, command_args);
+            break;
+        case (GETPERCENTOFPLAYERSWITHSCORERANGEINBOUNDS_CMD):
+            rtn_val = OnGetPercentOfPlayersWithScoreRangeInBounds(DS, command_args);
+            break;
+        case (SELECTLEVEL_CMD):
+            rtn_val = OnSelectLevel(DS, command_args);
+            break;
+        case (LEVELPERCENTILE_CMD):
+            rtn_val = OnLevelPercentile(DS, command_args);
+            break;
+        case (AVERAGELEVELINRANKRANGE_CMD):
+            rtn_val = OnAverageLevelInRankRange(DS, command_args);
+            break;
+        case (INITWITHMAXLEVEL_CMD):
+            rtn_val = OnInitWithMaxLevel(&DS, command_args);
+            break;
         case (COMMENT_CMD):
             rtn_val = error_free;
             break;
@@ -211,6 +249,7 @@ static errorType OnInit(void** DS, const char* const command) {
         printf("Init failed.\n");
         return error;
     };
+    initScale = scale;
     printf("Init done.\n");
 
     return error_free;
@@ -379,6 +418,141 @@ static errorType OnGetPlayersBound(void* DS, const char* const command) {
     return error_free;
 }
 
+/***************************************************************************/
+/* OnGetScoreDistributionInBounds                                          */
+/***************************************************************************/
+
+static errorType OnGetScoreDistributionInBounds(void* DS, const char* const command) {
+    int groupID;
+    int lowerLevel;
+    int higherLevel;
+    ValidateRead(sscanf(command, "%d %d %d", &groupID, &lowerLevel, &higherLevel), 3,
+                 "GetScoreDistributionInBounds failed.\n");
+    int counts[200] = {0};
+    StatusType res = GetScoreDistributionInBounds(DS, groupID, lowerLevel, higherLevel, counts);
+
+    if (res != SUCCESS) {
+        printf("GetScoreDistributionInBounds: %s\n", ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("GetScoreDistributionInBounds:");
+    for (int i = 0; i < initScale; i++) {
+        printf(" %d", counts[i]);
+    }
+    printf("\n");
+    return error_free;
+}
+
+/***************************************************************************/
+/* OnGetPercentOfPlayersWithScoreRangeInBounds                             */
+/***************************************************************************/
+
+static errorType OnGetPercentOfPlayersWithScoreRangeInBounds(void* DS, const char* const command) {
+    int groupID;
+    int lowerScore;
+    int higherScore;
+    int lowerLevel;
+    int higherLevel;
+    ValidateRead(sscanf(command, "%d %d %d %d %d", &groupID, &lowerScore, &higherScore, &lowerLevel, &higherLevel), 5,
+                 "GetPercentOfPlayersWithScoreRangeInBounds failed.\n");
+    double players = 0.0;
+    StatusType res = GetPercentOfPlayersWithScoreRangeInBounds(DS, groupID, lowerScore, higherScore, lowerLevel, higherLevel, &players);
+
+    if (res != SUCCESS) {
+        printf("GetPercentOfPlayersWithScoreRangeInBounds: %s\n", ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("GetPercentOfPlayersWithScoreRangeInBounds: %.2f\n", players);
+    return error_free;
+}
+
+/***************************************************************************/
+/* OnSelectLevel                                                           */
+/***************************************************************************/
+
+static errorType OnSelectLevel(void* DS, const char* const command) {
+    int groupID;
+    int k;
+    ValidateRead(sscanf(command, "%d %d", &groupID, &k), 2, "SelectLevel failed.\n");
+    int level = 0;
+    StatusType res = SelectLevel(DS, groupID, k, &level);
+
+    if (res != SUCCESS) {
+        printf("SelectLevel: %s\n", ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("SelectLevel: %d\n", level);
+    return error_free;
+}
+
+/***************************************************************************/
+/* OnLevelPercentile                                                       */
+/***************************************************************************/
+
+static errorType OnLevelPercentile(void* DS, const char* const command) {
+    int groupID;
+    double p;
+    ValidateRead(sscanf(command, "%d %lf", &groupID, &p), 2, "LevelPercentile failed.\n");
+    int level = 0;
+    StatusType res = LevelPercentile(DS, groupID, p, &level);
+
+    if (res != SUCCESS) {
+        printf("LevelPercentile: %s\n", ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("LevelPercentile: %d\n", level);
+    return error_free;
+}
+
+/***************************************************************************/
+/* OnAverageLevelInRankRange                                               */
+/***************************************************************************/
+
+static errorType OnAverageLevelInRankRange(void* DS, const char* const command) {
+    int groupID;
+    int r1;
+    int r2;
+    ValidateRead(sscanf(command, "%d %d %d", &groupID, &r1, &r2), 3, "AverageLevelInRankRange failed.\n");
+    double level = 0.0;
+    StatusType res = AverageLevelInRankRange(DS, groupID, r1, r2, &level);
+
+    if (res != SUCCESS) {
+        printf("AverageLevelInRankRange: %s\n", ReturnValToStr(res));
+        return error_free;
+    }
+
+    printf("AverageLevelInRankRange: %.2f\n", level);
+    return error_free;
+}
+
+/***************************************************************************/
+/* OnInitWithMaxLevel                                                      */
+/***************************************************************************/
+static errorType OnInitWithMaxLevel(void** DS, const char* const command) {
+    if (isInit) {
+        printf("InitWithMaxLevel was already called.\n");
+        return (error_free);
+    };
+    isInit = true;
+    int k;
+    int scale;
+    int maxLevel;
+    ValidateRead(sscanf(command, "%d %d %d", &k, &scale, &maxLevel), 3, "InitWithMaxLevel failed.\n");
+    *DS = InitWithMaxLevel(k, scale, maxLevel);
+    if (*DS == NULL) {
+        printf("InitWithMaxLevel failed.\n");
+        return error;
+    };
+    initScale = scale;
+    printf("InitWithMaxLevel done.\n");
+
+    return error_free;
+}
+
 /***************************************************************************/
 /* OnQuit                                                                  */
 /***************************************************************************/
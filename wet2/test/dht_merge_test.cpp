@@ -0,0 +1,105 @@
+// Checks DHT::merge(DHT&&): the merge takes over the nodes of the other table, so it allocates at most one bucket
+// array (the resize up front) whatever the sizes, and a duplicate id throws before anything is moved, leaving both
+// tables as they were.
+//
+// Build and run from this directory:
+//     g++ -std=c++11 -O2 -pthread -I.. -o dht_merge_test dht_merge_test.cpp
+//     ./dht_merge_test
+
+#include "DynamicHashTable.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static long long allocations = 0;
+
+void* operator new(std::size_t bytes) {
+    allocations++;
+    void* p = std::malloc(bytes > 0 ? bytes : 1);
+    if(!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if(!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// adds the ids first, first+1, ..., first+count-1
+static void fill(DHT& table, int first, int count) {
+    for(int id = first; id < first+count; ++id) {
+        table.addPlayer(std::make_shared<Player>(id));
+    }
+}
+
+static bool holds(DHT& table, int first, int count) {
+    for(int id = first; id < first+count; ++id) {
+        if(table.findPlayer(id) == nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void mergeAllocations(int size1, int size2) {
+    DHT table1, table2;
+    fill(table1, 0, size1);
+    fill(table2, size1, size2);
+
+    long long before = allocations;
+    table1.merge(std::move(table2));
+    long long used = allocations - before;
+    std::printf("merge of %d and %d players: %lld allocations\n", size1, size2, used);
+    check(used <= 1, "the merge allocates more than one bucket array");
+    check(table1.number_of_players == size1+size2 && holds(table1, 0, size1+size2), "the merged table");
+    check(table2.number_of_players == 0 && table2.findPlayer(size1) == nullptr, "the moved from table");
+}
+
+static void mergeDuplicate(int size1, int size2) {
+    DHT table1, table2;
+    fill(table1, 0, size1);
+    fill(table2, size1-1, size2);  // the last id of table1 is the first of table2
+    int buckets1 = table1.size, buckets2 = table2.size;
+
+    bool thrown = false;
+    try {
+        table1.merge(std::move(table2));
+    }
+    catch(const PlayerAlreadyExists& e) {
+        thrown = true;
+    }
+    std::printf("merge of %d and %d players with a duplicate: %s\n", size1, size2, thrown ? "thrown" : "not thrown");
+    check(thrown, "a duplicate id throws PlayerAlreadyExists");
+    check(table1.size == buckets1 && table1.number_of_players == size1 && holds(table1, 0, size1), "the table after a failed merge");
+    check(table2.size == buckets2 && table2.number_of_players == size2 && holds(table2, size1-1, size2), "the other table after a failed merge");
+}
+
+int main() {
+    mergeAllocations(1, 1);
+    mergeAllocations(1000, 10);
+    mergeAllocations(10, 1000);
+    mergeAllocations(100000, 100000);
+    mergeDuplicate(1, 1);
+    mergeDuplicate(1000, 1000);
+    mergeDuplicate(10, 100000);
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("passed\n");
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Checks the player handles of the C interface: a handle works until its player is removed, and after that every
+// ByHandle function returns FAILURE for it and leaves the other players alone, also when a new player got the same
+// id or the freed memory of the old one.
+//
+// Build and run from this directory (with -fsanitize=address to also check that no freed player is read):
+//     g++ -std=c++11 -O2 -pthread -I.. -o handle_test handle_test.cpp $(ls ../*.cpp | grep -v main2.cpp)
+//     ./handle_test
+
+#include "library2.h"
+#include <cstdio>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if(!condition) {
+        std::printf("FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// the average level of the highest m players of the group, -1 on failure
+static double average(void* ds, int group, int m) {
+    double avg = 0;
+    return (AverageHighestPlayerLevelByGroup(ds, group, m, &avg) == SUCCESS) ? avg : -1;
+}
+
+static void staleHandleOfReusedId() {
+    void* ds = Init(4, 10);
+    PlayerHandle old_handle = 0;
+    check(AddPlayerWithHandle(ds, 1, 1, 1, &old_handle) == SUCCESS && old_handle != 0, "add player 1 with a handle");
+    check(RemovePlayer(ds, 1) == SUCCESS, "remove player 1 by id");
+    check(AddPlayer(ds, 1, 2, 1) == SUCCESS, "add a new player 1 to group 2");
+    check(IncreasePlayerIDLevel(ds, 1, 3) == SUCCESS, "raise the new player 1");
+
+    check(RemovePlayerByHandle(ds, old_handle) == FAILURE, "remove by the handle of the removed player 1");
+    check(IncreasePlayerLevelByHandle(ds, old_handle, 5) == FAILURE, "raise by the handle of the removed player 1");
+    check(ChangePlayerScoreByHandle(ds, old_handle, 2) == FAILURE, "change the score by the handle of the removed player 1");
+    check(average(ds, 2, 1) == 3 && average(ds, 0, 1) == 3, "the new player 1 is untouched");
+    check(IncreasePlayerIDLevel(ds, 1, 1) == SUCCESS && average(ds, 2, 1) == 4, "the new player 1 is still found by id");
+    Quit(&ds);
+}
+
+static void handleOfRemovedPlayer() {
+    void* ds = Init(4, 10);
+    PlayerHandle first = 0, second = 0;
+    check(AddPlayerWithHandle(ds, 2, 3, 1, &first) == SUCCESS, "add player 2 with a handle");
+    check(IncreasePlayerLevelByHandle(ds, first, 2) == SUCCESS && average(ds, 3, 1) == 2, "raise player 2 by handle");
+    check(ChangePlayerScoreByHandle(ds, first, 5) == SUCCESS, "change the score of player 2 by handle");
+    check(RemovePlayerByHandle(ds, first) == SUCCESS, "remove player 2 by handle");
+    check(RemovePlayerByHandle(ds, first) == FAILURE, "remove player 2 by handle twice");
+    check(RemovePlayer(ds, 2) == FAILURE, "player 2 is gone by id too");
+
+    // the next player takes the slot of the released handle, with a new generation
+    check(AddPlayerWithHandle(ds, 3, 3, 1, &second) == SUCCESS && second != first, "a new handle differs from a released one");
+    check(IncreasePlayerLevelByHandle(ds, first, 1) == FAILURE, "the released handle stays refused");
+    check(IncreasePlayerLevelByHandle(ds, second, 1) == SUCCESS && average(ds, 3, 1) == 1, "the new handle works");
+
+    check(RemovePlayerByHandle(ds, 0) == INVALID_INPUT, "the handle 0");
+    check(RemovePlayerByHandle(ds, (7ULL << 32) | 1000) == FAILURE, "a handle that was never given out");
+    Quit(&ds);
+}
+
+static void manyHandles(int players) {
+    void* ds = Init(8, 10);
+    PlayerHandle handles[2000];
+    for(int id = 1; id <= players; ++id) {
+        AddPlayerWithHandle(ds, id, id % 8 + 1, id % 10 + 1, &handles[id-1]);
+    }
+    for(int id = 2; id <= players; id += 2) {
+        RemovePlayer(ds, id);
+        AddPlayer(ds, id, 1, 1);  // same id, no handle
+    }
+    int refused = 0, raised = 0;
+    for(int id = 1; id <= players; ++id) {
+        StatusType res = IncreasePlayerLevelByHandle(ds, handles[id-1], 1);
+        refused += (res == FAILURE);
+        raised += (res == SUCCESS);
+    }
+    std::printf("%d handles: %d raised, %d refused\n", players, raised, refused);
+    check(raised == (players+1)/2 && refused == players/2, "only the handles of players that weren't removed work");
+    check(average(ds, 0, raised) == 1 && average(ds, 0, raised+1) < 1, "exactly the players of working handles were raised");
+    Quit(&ds);
+}
+
+int main() {
+    staleHandleOfReusedId();
+    handleOfRemovedPlayer();
+    manyHandles(2000);
+    if(failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("passed\n");
+    return 0;
+}